@@ -0,0 +1,84 @@
+// Times the templated brightness/contrast kernels (applyAffine: a LUT for
+// 8-bit, the unrolled arithmetic loop otherwise) against OpenCV's generic
+// path (cv::Mat::convertTo, what BrightnessContrastNode falls back to) for
+// 1, 3 and 4 channels at 8U, 16U and 32F.
+//
+//   make bench && ./pixel_kernels_bench [width height iterations]
+//
+// Each case is warmed up once, then reports the median of `iterations` runs
+// and the largest difference between the two results (rounding differs by
+// at most one level for integer depths).
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "../utils/PixelKernels.h"
+
+namespace {
+
+template <typename Fn>
+double medianMillis(int iterations, Fn&& fn) {
+    fn(); // warm-up: allocations, first-touch page faults
+    std::vector<double> times;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+    return times[times.size() / 2];
+}
+
+template <typename T, int CN>
+void runCase(cv::Size size, int iterations) {
+    const int type = CV_MAKETYPE(PixelTraits<T>::depth, CN);
+    cv::Mat src(size, type);
+    cv::randu(src, cv::Scalar::all(0), cv::Scalar::all(PixelTraits<T>::maxValue));
+
+    // the node's mapping of contrast 1.3, brightness +20 (8-bit units)
+    const float contrast = 1.3f;
+    const float offset = 20.0f * PixelTraits<T>::maxValue / 255.0f;
+    std::array<float, CN> alpha, beta;
+    alpha.fill(contrast);
+    beta.fill(offset);
+
+    cv::Mat templated, generic;
+    double templatedMs = medianMillis(iterations, [&] { applyAffine<T, CN>(src, templated, alpha, beta); });
+    double genericMs = medianMillis(iterations, [&] { src.convertTo(generic, -1, contrast, offset); });
+
+    double maxDiff = cv::norm(templated, generic, cv::NORM_INF);
+    const char* depthName = PixelTraits<T>::depth == CV_8U ? "8U" : PixelTraits<T>::depth == CV_16U ? "16U" : "32F";
+    std::printf("%-4s %d ch   templated %8.2f ms   cv::convertTo %8.2f ms   speedup %5.2fx   max diff %g\n",
+                depthName, CN, templatedMs, genericMs, genericMs / templatedMs, maxDiff);
+}
+
+template <typename T>
+void runDepth(cv::Size size, int iterations) {
+    runCase<T, 1>(size, iterations);
+    runCase<T, 3>(size, iterations);
+    runCase<T, 4>(size, iterations);
+}
+
+}
+
+int main(int argc, char** argv) {
+    cv::Size size(4096, 2160);
+    int iterations = 20;
+    if (argc >= 3) size = cv::Size(std::atoi(argv[1]), std::atoi(argv[2]));
+    if (argc >= 4) iterations = std::max(1, std::atoi(argv[3]));
+    if (size.width <= 0 || size.height <= 0) {
+        std::fprintf(stderr, "usage: %s [width height iterations]\n", argv[0]);
+        return 1;
+    }
+
+    // both paths single-threaded: this compares the inner loops, not pools
+    cv::setNumThreads(1);
+    std::printf("Brightness/contrast, %d x %d, median of %d runs\n", size.width, size.height, iterations);
+    runDepth<uint8_t>(size, iterations);
+    runDepth<uint16_t>(size, iterations);
+    runDepth<float>(size, iterations);
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include "BatchRenderer.h"
+#include "../nodes/DirectoryInputNode.h"
+#include "../nodes/OutputNode.h"
+#include "../utils/EncoderPool.h"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+BatchRenderer::~BatchRenderer() {
+    cancel();
+    wait();
+}
+
+bool BatchRenderer::start(const Graph& graph, const Options& options) {
+    if (running) return false;
+    wait(); // reap the previous run
+
+    const DirectoryInputNode* source = nullptr;
+    bool hasOutput = false;
+    for (const auto& [id, node] : graph.nodes) {
+        if (auto* directory = dynamic_cast<const DirectoryInputNode*>(node.get())) {
+            if (!source) source = directory;
+        } else if (dynamic_cast<const OutputNode*>(node.get())) {
+            hasOutput = true;
+        }
+    }
+
+    // list again rather than trusting the last scan: files may have arrived
+    files = source ? DirectoryInputNode::listFiles(source->getPattern()) : std::vector<std::string>();
+    if (files.empty() || !hasOutput) {
+        std::cerr << "Batch render needs a Directory Input with matching files and an Output node\n";
+        return false;
+    }
+
+    int threads = options.workers > 0 ? options.workers : (int)std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, (int)files.size());
+
+    // one immutable copy for every worker; each evaluates it in its own context
+    snapshot = std::make_shared<Graph>(graph.clone());
+    snapshot->proxyScale = 1; // final renders are always full resolution
+    sourceId = source->id;
+    settled = std::make_unique<std::once_flag>();
+
+    cancelled = false;
+    nextFile = 0;
+    filesDone = 0;
+    filesFailed = 0;
+    activeWorkers = threads;
+    if (threads > 1) {
+        savedCvThreads = cv::getNumThreads();
+        cv::setNumThreads(1);
+    }
+    startTime = std::chrono::steady_clock::now();
+    running = true;
+
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back(&BatchRenderer::workerLoop, this);
+    }
+    return true;
+}
+
+void BatchRenderer::cancel() {
+    cancelled = true;
+}
+
+void BatchRenderer::wait() {
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+    workers.clear();
+    restoreCvThreads(); // normally done by the last worker already
+}
+
+void BatchRenderer::restoreCvThreads() {
+    int saved = savedCvThreads.exchange(-1);
+    if (saved >= 0) cv::setNumThreads(saved);
+}
+
+double BatchRenderer::getFilesPerSecond() const {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return seconds > 0 ? filesDone / seconds : 0.0;
+}
+
+void BatchRenderer::settle() {
+    // other (still image) inputs in the snapshot load their files once, before
+    // any context reads them; the batch source itself is fed per context
+    static_cast<InputNode*>(snapshot->nodes[sourceId].get())->setStreamedImage(cv::Mat());
+    snapshot->evaluate();
+    snapshot->waitForPendingWork();
+    snapshot->evaluate();
+}
+
+void BatchRenderer::workerLoop() {
+    std::call_once(*settled, &BatchRenderer::settle, this);
+
+    const Graph& graph = *snapshot;
+    std::vector<const OutputNode*> outputs;
+    for (const auto& [id, node] : graph.nodes) {
+        if (auto* output = dynamic_cast<const OutputNode*>(node.get())) outputs.push_back(output);
+    }
+
+    ExecutionContext context;
+    while (!cancelled) {
+        int index = nextFile++;
+        if (index >= (int)files.size()) break;
+        const std::string& path = files[index];
+
+        // decode here rather than on the shared I/O pool so it scales with workers
+        cv::Mat image = InputNode::decodeFile(path, graph.workingFormat, graph.planarLayout);
+        if (image.empty()) {
+            std::cerr << "Failed to load image: " << path << "\n";
+            ++filesFailed;
+            ++filesDone;
+            continue;
+        }
+
+        context.setSource(sourceId, image);
+        graph.evaluate(context);
+
+        bool ok = true;
+        for (const OutputNode* output : outputs) {
+            cv::Mat result = context.output(output->id);
+            if (result.empty()) continue;
+
+            std::string target = output->batchOutputPath(path, index);
+            std::error_code ec;
+            std::filesystem::path parent = std::filesystem::path(target).parent_path();
+            if (!parent.empty()) std::filesystem::create_directories(parent, ec);
+
+            ok &= EncoderPool::encode({ target, output->getFormat(), output->encodeParams(), result }).ok;
+        }
+        if (!ok) ++filesFailed;
+        ++filesDone;
+    }
+
+    if (--activeWorkers == 0) {
+        restoreCvThreads();
+        std::cout << "Batch rendered " << filesDone << " files (" << filesFailed << " failed) at "
+                  << getFilesPerSecond() << " files/s\n";
+        running = false;
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Graph.h"
+
+// Runs a graph once per file of its Directory Input node, fanned out over a
+// pool of worker threads. All workers evaluate one snapshot of the graph
+// (Graph::clone, taken in start()), each through its own ExecutionContext,
+// and do the whole decode -> evaluate -> encode chain for a file on their own
+// thread, so they share nothing mutable but the file index counter and
+// throughput scales with cores. Outputs are named from each Output node's
+// batch pattern.
+//
+// Parallelism is across files: while more than one worker runs, OpenCV's own
+// thread pool is limited to one thread (cv::setNumThreads, process-wide) so
+// N workers don't each fan out over every core. It is restored when the
+// batch finishes.
+//
+// The caller keeps using (and editing) the original graph.
+class BatchRenderer {
+public:
+    struct Options {
+        int workers = 0; // 0 = one per hardware thread
+    };
+
+    ~BatchRenderer();
+
+    // Returns false if the graph has no Directory Input with matching files
+    // or no Output node.
+    bool start(const Graph& graph, const Options& options);
+    void cancel();
+    void wait();
+
+    bool isRunning() const { return running; }
+    int getFilesDone() const { return filesDone; }
+    int getFilesFailed() const { return filesFailed; }
+    int getFilesTotal() const { return (int)files.size(); }
+    int getWorkerCount() const { return (int)workers.size(); }
+    double getFilesPerSecond() const;
+
+private:
+    std::vector<std::thread> workers;
+    std::vector<std::string> files;
+    std::shared_ptr<Graph> snapshot;
+    int sourceId = 0;
+    std::unique_ptr<std::once_flag> settled;
+
+    std::atomic<bool> running{false};
+    std::atomic<bool> cancelled{false};
+    std::atomic<int> nextFile{0};
+    std::atomic<int> filesDone{0};
+    std::atomic<int> filesFailed{0};
+    std::atomic<int> activeWorkers{0};
+    // OpenCV's thread count is process-wide; -1 once restored (or untouched)
+    std::atomic<int> savedCvThreads{-1};
+    std::chrono::steady_clock::time_point startTime;
+
+    void settle();
+    void workerLoop();
+    void restoreCvThreads();
+};
@@ -0,0 +1,31 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <unordered_map>
+#include <vector>
+#include "IntegralCache.h"
+
+// Per-evaluation state for Graph::evaluate(ExecutionContext&): every node's
+// outputs plus images fed to source nodes. The graph itself is only read, so
+// one graph can be evaluated by many contexts on different threads at once.
+// A context is reused across evaluations; output buffers are recycled, so a
+// result is valid until the next evaluate() on the same context.
+class ExecutionContext {
+public:
+    // Overrides a source node's output (e.g. the image an Input node would
+    // have loaded) for evaluations in this context.
+    void setSource(int nodeId, const cv::Mat& image) { sources[nodeId] = image; }
+    void clearSources() { sources.clear(); }
+
+    cv::Mat output(int nodeId, int port = 0) const {
+        auto it = outputs.find(nodeId);
+        if (it == outputs.end() || port < 0 || port >= (int)it->second.size()) return cv::Mat();
+        return it->second[port];
+    }
+
+private:
+    friend class Graph;
+
+    std::unordered_map<int, std::vector<cv::Mat>> outputs;
+    std::unordered_map<int, cv::Mat> sources;
+    IntegralCache integrals;
+};
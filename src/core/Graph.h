@@ -3,8 +3,11 @@
 #include <vector>
 #include <unordered_map>
 #include <memory>
+#include <algorithm>
+#include <cassert>
 #include "Node.h"
-#include "../nodes/InputNode.h"
+#include "ExecutionContext.h"
+#include "IntegralCache.h"
 
 struct Link {
     int id;
@@ -16,10 +19,18 @@ class Graph {
 private:
     int nextNodeId = 1;
     int nextLinkId = 2;
+
+    // what each node last processed: (input slot, source node, port, version)
+    // per link, followed by its requested output ports
+    std::unordered_map<int, std::vector<uint64_t>> lastSeen;
+    IntegralCache integrals;
 public:
     std::unordered_map<int, std::shared_ptr<Node>> nodes;
     std::vector<Link> links;
     bool hasCycle = false;
+    WorkingFormat workingFormat = WorkingFormat::U8;
+    bool planarLayout = false;
+    int proxyScale = 1;
     
     int addNode(std::shared_ptr<Node> node) {
         node->id = nextNodeId;
@@ -28,9 +39,9 @@ public:
         return node->id;
     }
 
-    int addLink(int fromNode, int fromAttrIndex, int toNode, int toInputIndex) {
-        int fromAttr = fromNode * 1000 + fromAttrIndex;
-        int toAttr   = toNode   * 1000 + toInputIndex;
+    int addLink(int fromNode, int fromPort, int toNode, int toInputIndex) {
+        int fromAttr = outputAttrId(fromNode, fromPort);
+        int toAttr   = inputAttrId(toNode, toInputIndex);
 
         for (const auto& link : links) {
             if (link.fromAttr == fromAttr && link.toAttr == toAttr) {
@@ -47,8 +58,26 @@ public:
         return link.id;
     }
     
+    // Same settings, links and (cloned) nodes, sharing no state with this
+    // graph, so the copy can be evaluated on another thread.
+    Graph clone() const {
+        Graph copy;
+        copy.nextNodeId = nextNodeId;
+        copy.nextLinkId = nextLinkId;
+        copy.links = links;
+        copy.hasCycle = hasCycle;
+        copy.workingFormat = workingFormat;
+        copy.planarLayout = planarLayout;
+        copy.proxyScale = proxyScale;
+        for (const auto& [id, node] : nodes) {
+            copy.nodes[id] = node->clone();
+        }
+        return copy;
+    }
+
     void removeNode(int id) {
         nodes.erase(id);
+        lastSeen.erase(id);
         links.erase(std::remove_if(links.begin(), links.end(),
             [id](const Link& link) {
                 return link.toNode == id || link.fromNode == id;
@@ -66,7 +95,7 @@ public:
         );
     }
 
-    std::vector<Link> getInputLinks(int id) {
+    std::vector<Link> getInputLinks(int id) const {
         std::vector<Link> res;
         for (const Link& link : links) {
             if (link.toNode == id) {
@@ -76,7 +105,7 @@ public:
         return res;
     }
 
-    std::unordered_map<int, std::vector<int>> buildAdjacencyList() {
+    std::unordered_map<int, std::vector<int>> buildAdjacencyList() const {
         std::unordered_map<int, std::vector<int>> adjacencyList;
         
         for (const auto& [id, ptr] : nodes) {
@@ -91,6 +120,13 @@ public:
     }
 
     std::vector<int> topologicalSort() {
+        auto toposort = evaluationOrder();
+        hasCycle = toposort.empty() && !nodes.empty();
+        return toposort;
+    }
+
+    // Topological order of the nodes, or empty if the graph has a cycle.
+    std::vector<int> evaluationOrder() const {
         auto adjacencyList = buildAdjacencyList();
         std::unordered_map<int, int> indegree;
         std::vector<int> toposort;
@@ -122,14 +158,62 @@ public:
 
         if (toposort.size() != adjacencyList.size()) {
             toposort.clear();
-            hasCycle = true;
-        } else {
-            hasCycle = false;
         }
 
         return toposort;
     }
 
+    // Output ports of a node that at least one link consumes.
+    std::vector<bool> getRequestedOutputs(int id) const {
+        std::vector<bool> requested(nodes.at(id)->outputCount(), false);
+        for (const Link& link : links) {
+            int port = attrIndex(link.fromAttr);
+            if (link.fromNode == id && port < (int)requested.size()) {
+                requested[port] = true;
+            }
+        }
+        return requested;
+    }
+
+    // Every node that depends on `source` (itself included), mapped to the
+    // largest sum of haloRows() along a chain of links from the source down
+    // to and including that node. Halos only add up along a chain; parallel
+    // branches each need their own.
+    std::unordered_map<int, int> accumulatedHaloRows(int source) const {
+        std::unordered_map<int, int> halo;
+        auto it = nodes.find(source);
+        if (it == nodes.end()) return halo;
+        halo[source] = it->second->haloRows();
+
+        for (int id : evaluationOrder()) {
+            auto reached = halo.find(id);
+            if (reached == halo.end()) continue;
+            int rows = reached->second;
+            for (const Link& link : links) {
+                if (link.fromNode != id) continue;
+                int total = rows + nodes.at(link.toNode)->haloRows();
+                auto [entry, inserted] = halo.try_emplace(link.toNode, total);
+                if (!inserted) entry->second = std::max(entry->second, total);
+            }
+        }
+        return halo;
+    }
+
+    // Rows of context above and below a strip of `source` so `target` comes
+    // out exact for the strip's own rows; -1 when `target` doesn't depend on
+    // `source`.
+    int haloRowsBetween(int source, int target) const {
+        auto halo = accumulatedHaloRows(source);
+        auto it = halo.find(target);
+        return it == halo.end() ? -1 : it->second;
+    }
+
+    void waitForPendingWork() {
+        for (const auto& [id, node] : nodes) {
+            node->waitForPendingWork();
+        }
+    }
+
     void evaluate() {
         auto toposort = topologicalSort();
 
@@ -141,25 +225,99 @@ public:
         for (int nodeId : toposort) {
             auto node = nodes[nodeId];
             auto inputs = getInputLinks(nodeId);
+            auto requested = getRequestedOutputs(nodeId);
 
-            assert(inputs.size() <= 2);
+            node->setWorkingFormat(workingFormat);
+            node->setPlanarLayout(planarLayout);
+            node->setProxyScale(proxyScale);
+            node->setRequestedOutputs(requested);
 
-            std::vector <cv::Mat> outputs;
-            
-            if (inputs.size() == 1 || inputs.size() == 2) {
-                if (inputs.size() == 2 && (inputs[0].toAttr % 1000 > inputs[1].toAttr % 1000)) {
-                    std::swap(inputs[0], inputs[1]);
-                }
+            if (node->inputCount() == 0) {
+                // sources poll for new data themselves (loads, playback, file changes)
+                node->process();
+                node->dirty = false;
+                continue;
+            }
+
+            std::vector<uint64_t> seen;
+            for (const auto& link : inputs) {
+                seen.insert(seen.end(), {
+                    (uint64_t)link.toAttr, (uint64_t)link.fromAttr, nodes[link.fromNode]->version
+                });
+            }
+            for (bool port : requested) {
+                seen.push_back(port);
+            }
+
+            auto last = lastSeen.find(nodeId);
+            if (!node->dirty && last != lastSeen.end() && last->second == seen) {
                 for (const auto& link : inputs) {
-                    outputs.push_back(nodes[link.fromNode]->getOutput());
+                    IntegralKind kind = node->inputIntegralKind(attrIndex(link.toAttr));
+                    if (kind != IntegralKind::None) integrals.touch(link.fromAttr, kind);
                 }
-            }            
+                continue; // nothing upstream changed
+            }
 
-            if (!dynamic_cast<InputNode*>(node.get()) && !inputs.empty()) {
-                node->setInputs(outputs);
+            // inputs are positional: slot i holds whatever is linked to input port i
+            std::vector <cv::Mat> outputs(node->inputCount());
+            std::vector<IntegralImagePtr> tables(node->inputCount());
+
+            for (const auto& link : inputs) {
+                int slot = attrIndex(link.toAttr);
+                assert(slot < (int)outputs.size());
+                outputs[slot] = nodes[link.fromNode]->getOutput(attrIndex(link.fromAttr));
+                IntegralKind kind = node->inputIntegralKind(slot);
+                if (kind != IntegralKind::None) {
+                    tables[slot] = integrals.get(link.fromAttr, kind, nodes[link.fromNode]->version, outputs[slot]);
+                }
             }
 
+            node->setInputs(outputs);
+            node->setInputIntegrals(tables);
             node->process();
+            node->dirty = false;
+            ++node->version;
+            lastSeen[nodeId] = std::move(seen);
+        }
+        integrals.sweep();
+    }
+
+    // Evaluates every node into `context` through Node::compute() instead of
+    // the nodes' own state. The graph is only read (nobody may edit it in the
+    // meantime), so many contexts can evaluate it concurrently. Sources not
+    // fed through context.setSource() contribute the image they already hold.
+    // Returns false if the graph has a cycle.
+    bool evaluate(ExecutionContext& context) const {
+        auto order = evaluationOrder();
+        if (order.empty() && !nodes.empty()) return false;
+        // output buffers are recycled between evaluations: tables can't carry over
+        context.integrals.clear();
+
+        for (int nodeId : order) {
+            const Node& node = *nodes.at(nodeId);
+            std::vector<cv::Mat>& outputs = context.outputs[nodeId];
+            outputs.resize(std::max(node.outputCount(), 1));
+
+            auto fed = context.sources.find(nodeId);
+            if (fed != context.sources.end()) {
+                outputs[0] = fed->second;
+                continue;
+            }
+
+            std::vector<cv::Mat> inputs(node.inputCount());
+            std::vector<IntegralImagePtr> tables(node.inputCount());
+            for (const auto& link : getInputLinks(nodeId)) {
+                int slot = attrIndex(link.toAttr);
+                assert(slot < (int)inputs.size());
+                inputs[slot] = context.output(link.fromNode, attrIndex(link.fromAttr));
+                IntegralKind kind = node.inputIntegralKind(slot);
+                if (kind != IntegralKind::None) {
+                    tables[slot] = context.integrals.get(link.fromAttr, kind, 0, inputs[slot]);
+                }
+            }
+
+            node.computeWithIntegrals(inputs, outputs, getRequestedOutputs(nodeId), tables);
         }
+        return true;
     }
 };
\ No newline at end of file
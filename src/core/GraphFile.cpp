@@ -0,0 +1,112 @@
+#include "GraphFile.h"
+#include "../nodes/InputNode.h"
+#include "../nodes/DirectoryInputNode.h"
+#include "../nodes/SequenceInputNode.h"
+#include "../nodes/TiledTiffInputNode.h"
+#include "../nodes/OutputNode.h"
+#include "../nodes/BrightnessContrastNode.h"
+#include "../nodes/BlurNode.h"
+#include "../nodes/SplitChannelsNode.h"
+#include "../nodes/BlendNode.h"
+#include "../nodes/ConvolutionNode.h"
+#include "../nodes/EdgeNode.h"
+#include "../nodes/ThresholdNode.h"
+#include "../nodes/ResizeNode.h"
+#include "../nodes/TransformNode.h"
+#include "../nodes/ColorConvertNode.h"
+#include <iostream>
+#include <map>
+
+std::shared_ptr<Node> createNode(const std::string& type) {
+    if (type == "Input") return std::make_shared<InputNode>(0);
+    if (type == "DirectoryInput") return std::make_shared<DirectoryInputNode>(0);
+    if (type == "SequenceInput") return std::make_shared<SequenceInputNode>(0);
+    if (type == "TiledTiffInput") return std::make_shared<TiledTiffInputNode>(0);
+    if (type == "Output") return std::make_shared<OutputNode>(0);
+    if (type == "BrightnessContrast") return std::make_shared<BrightnessContrastNode>(0);
+    if (type == "Blur") return std::make_shared<BlurNode>(0);
+    if (type == "SplitChannels") return std::make_shared<SplitChannelsNode>(0);
+    if (type == "Blend") return std::make_shared<BlendNode>(0);
+    if (type == "Convolution") return std::make_shared<ConvolutionNode>(0);
+    if (type == "Edge") return std::make_shared<EdgeNode>(0);
+    if (type == "Threshold") return std::make_shared<ThresholdNode>(0);
+    if (type == "Resize") return std::make_shared<ResizeNode>(0);
+    if (type == "Transform") return std::make_shared<TransformNode>(0);
+    if (type == "ColorConvert") return std::make_shared<ColorConvertNode>(0);
+    return nullptr;
+}
+
+bool saveGraph(const Graph& graph, const std::string& path) {
+    try {
+        cv::FileStorage fs(path, cv::FileStorage::WRITE);
+        if (!fs.isOpened()) return false;
+
+        fs << "workingFormat" << (int)graph.workingFormat;
+        fs << "planarLayout" << (int)graph.planarLayout;
+
+        // ordered by id so files diff cleanly
+        std::map<int, std::shared_ptr<Node>> ordered(graph.nodes.begin(), graph.nodes.end());
+        fs << "nodes" << "[";
+        for (const auto& [id, node] : ordered) {
+            fs << "{" << "id" << id << "type" << node->typeName() << "name" << node->name;
+            node->writeParameters(fs);
+            fs << "}";
+        }
+        fs << "]";
+
+        fs << "links" << "[";
+        for (const auto& link : graph.links) {
+            fs << "{" << "from" << link.fromNode << "fromPort" << attrIndex(link.fromAttr)
+               << "to" << link.toNode << "toInput" << attrIndex(link.toAttr) << "}";
+        }
+        fs << "]";
+        return true;
+    } catch (const cv::Exception& e) {
+        std::cerr << "Failed to save graph " << path << ": " << e.what() << "\n";
+        return false;
+    }
+}
+
+bool loadGraph(const std::string& path, Graph& graph) {
+    try {
+        cv::FileStorage fs(path, cv::FileStorage::READ);
+        if (!fs.isOpened()) {
+            std::cerr << "Cannot open graph file: " << path << "\n";
+            return false;
+        }
+
+        Graph loaded;
+        int format = 0, planar = 0;
+        cv::read(fs["workingFormat"], format, 0);
+        cv::read(fs["planarLayout"], planar, 0);
+        loaded.workingFormat = static_cast<WorkingFormat>(format);
+        loaded.planarLayout = planar != 0;
+
+        // ids are reassigned on load; links are remapped through this
+        std::map<int, int> idMap;
+        for (const auto& entry : fs["nodes"]) {
+            std::string type = (std::string)entry["type"];
+            auto node = createNode(type);
+            if (!node) {
+                std::cerr << "Unknown node type '" << type << "' in " << path << "\n";
+                return false;
+            }
+            cv::read(entry["name"], node->name, node->name);
+            node->readParameters(entry);
+            idMap[(int)entry["id"]] = loaded.addNode(node);
+        }
+
+        for (const auto& entry : fs["links"]) {
+            auto from = idMap.find((int)entry["from"]);
+            auto to = idMap.find((int)entry["to"]);
+            if (from == idMap.end() || to == idMap.end()) continue;
+            loaded.addLink(from->second, (int)entry["fromPort"], to->second, (int)entry["toInput"]);
+        }
+
+        graph = std::move(loaded);
+        return true;
+    } catch (const cv::Exception& e) {
+        std::cerr << "Failed to load graph " << path << ": " << e.what() << "\n";
+        return false;
+    }
+}
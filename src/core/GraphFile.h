@@ -0,0 +1,16 @@
+#pragma once
+#include <memory>
+#include <string>
+#include "Graph.h"
+
+// Graph files hold the settings, nodes (type, id, name, parameters) and
+// links of a graph, never images. Any format cv::FileStorage understands
+// works; the extension picks it (.yml, .json, .xml).
+bool saveGraph(const Graph& graph, const std::string& path);
+
+// Replaces `graph` with the file's contents. Returns false and leaves
+// `graph` untouched if the file can't be read or names an unknown node type.
+bool loadGraph(const std::string& path, Graph& graph);
+
+// New node of a typeName() as stored in graph files, or nullptr.
+std::shared_ptr<Node> createNode(const std::string& type);
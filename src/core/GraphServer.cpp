@@ -0,0 +1,363 @@
+#include "GraphServer.h"
+#include "GraphFile.h"
+#include "../nodes/InputNode.h"
+#include "../nodes/OutputNode.h"
+#include "../utils/EncoderPool.h"
+#include "../utils/SourceImage.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <iostream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using Clock = std::chrono::steady_clock;
+
+static double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Reads exactly `size` bytes. Any descriptors passed along (SCM_RIGHTS) are
+// appended to `fds`; a plain recv() would silently close them.
+static bool readAll(int fd, void* data, size_t size, std::vector<int>& fds) {
+    auto* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        iovec iov { bytes, size };
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * 4)];
+        msghdr message {};
+        message.msg_iov = &iov;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+
+        ssize_t n = recvmsg(fd, &message, MSG_CMSG_CLOEXEC);
+        if (n <= 0) return false;
+
+        for (cmsghdr* header = CMSG_FIRSTHDR(&message); header; header = CMSG_NXTHDR(&message, header)) {
+            if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS) {
+                size_t count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                const int* received = reinterpret_cast<const int*>(CMSG_DATA(header));
+                fds.insert(fds.end(), received, received + count);
+            }
+        }
+        bytes += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static void closeAll(std::vector<int>& fds) {
+    for (int fd : fds) close(fd);
+    fds.clear();
+}
+
+static bool writeAll(int fd, const void* data, size_t size) {
+    auto* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t n = send(fd, bytes, size, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        bytes += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+GraphServer::~GraphServer() {
+    stop();
+}
+
+bool GraphServer::addGraph(const std::string& name, const std::string& path) {
+    auto graph = std::make_shared<Graph>();
+    if (!loadGraph(path, *graph)) return false;
+
+    ServedGraph served;
+    InputNode* source = nullptr;
+    const OutputNode* output = nullptr;
+    std::map<int, std::shared_ptr<Node>> ordered(graph->nodes.begin(), graph->nodes.end());
+    for (const auto& [id, pointer] : ordered) {
+        Node* node = pointer.get();
+        if (!source) source = dynamic_cast<InputNode*>(node);
+        if (!output) output = dynamic_cast<const OutputNode*>(node);
+    }
+    if (!source || !output) {
+        std::cerr << "Graph '" << name << "' needs an Input and an Output node\n";
+        return false;
+    }
+
+    // decode any other still-image inputs now; requests only read them
+    source->setStreamedImage(cv::Mat());
+    graph->evaluate();
+    graph->waitForPendingWork();
+    graph->evaluate();
+
+    served.sourceId = source->id;
+    served.outputId = output->id;
+    served.format = output->getFormat() == "RAW" ? "TIFF" : output->getFormat(); // .nbraw is file-only
+    served.extension = served.format == "TIFF" ? ".tif" : output->fileExtension();
+    served.params = output->encodeParams();
+    served.stats = std::make_unique<LatencyStats>();
+    served.graph = std::move(graph);
+    graphs[name] = std::move(served);
+    std::cout << "Loaded graph '" << name << "' from " << path << "\n";
+    return true;
+}
+
+bool GraphServer::start(const Options& serverOptions) {
+    options = serverOptions;
+
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if (options.socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path too long: " << options.socketPath << "\n";
+        return false;
+    }
+    std::strncpy(address.sun_path, options.socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    unlink(options.socketPath.c_str()); // stale socket from a previous run
+    if (listenFd < 0 || bind(listenFd, (sockaddr*)&address, sizeof(address)) < 0 || listen(listenFd, 64) < 0) {
+        std::cerr << "Cannot listen on " << options.socketPath << ": " << std::strerror(errno) << "\n";
+        if (listenFd >= 0) close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+
+    stopping = false;
+    acceptThread = std::thread(&GraphServer::acceptLoop, this);
+    std::cout << "Serving " << graphs.size() << " graph(s) on " << options.socketPath << "\n";
+    return true;
+}
+
+void GraphServer::stop() {
+    stopping = true;
+    if (acceptThread.joinable()) acceptThread.join();
+    if (listenFd >= 0) {
+        close(listenFd);
+        unlink(options.socketPath.c_str());
+        listenFd = -1;
+    }
+}
+
+std::string GraphServer::statsReport() const {
+    std::string report;
+    for (const auto& [name, served] : graphs) {
+        report += name + ": " + served.stats->report() + "\n";
+    }
+    return report;
+}
+
+void GraphServer::acceptLoop() {
+    while (!stopping) {
+        // poll with a timeout so stop() is noticed without closing the socket under us
+        pollfd pending { listenFd, POLLIN, 0 };
+        if (poll(&pending, 1, 200) > 0) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd >= 0) {
+                if ((int)connections.size() >= options.maxConnections) {
+                    close(fd);
+                } else {
+                    auto connection = std::make_unique<Connection>();
+                    connection->fd = fd;
+                    connection->thread = std::thread(&GraphServer::serve, this, connection.get());
+                    connections.push_back(std::move(connection));
+                }
+            }
+        }
+
+        // reap finished connections
+        for (auto it = connections.begin(); it != connections.end();) {
+            if ((*it)->done) {
+                (*it)->thread.join();
+                it = connections.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // unblock connections waiting in recv() and wait for them
+    for (auto& connection : connections) {
+        shutdown(connection->fd, SHUT_RDWR);
+    }
+    for (auto& connection : connections) {
+        connection->thread.join();
+    }
+    connections.clear();
+}
+
+void GraphServer::serve(Connection* connection) {
+    Session session;
+    try {
+        while (!stopping && handleRequest(connection->fd, session)) {}
+    } catch (...) {
+        // handleRequest answers failed requests itself; anything escaping it
+        // (e.g. allocating the reply) only ends this connection
+    }
+    closeAll(session.fds);
+    close(connection->fd);
+    connection->done = true;
+}
+
+bool GraphServer::sendResponse(int fd, uint32_t status, uint32_t micros, const void* data, size_t size) {
+    uint32_t header[3] = { status, micros, (uint32_t)size };
+    return writeAll(fd, header, sizeof(header)) && writeAll(fd, data, size);
+}
+
+bool GraphServer::handleRequest(int fd, Session& session) {
+    constexpr uint32_t kMaxName = 4096;
+    constexpr uint32_t kMaxPayload = 1u << 30;
+
+    // descriptors belong to the request they arrived with
+    closeAll(session.fds);
+    std::vector<int>& fds = session.fds;
+
+    uint32_t op, nameLength, payloadLength;
+    if (!readAll(fd, &op, 4, fds) || !readAll(fd, &nameLength, 4, fds) || nameLength > kMaxName) return false;
+    std::string name(nameLength, '\0');
+    if (!readAll(fd, name.data(), nameLength, fds) || !readAll(fd, &payloadLength, 4, fds) || payloadLength > kMaxPayload) return false;
+    std::vector<uchar> payload(payloadLength);
+    if (!readAll(fd, payload.data(), payloadLength, fds)) return false;
+
+    auto start = Clock::now();
+    auto fail = [&](const std::string& message, LatencyStats* stats) {
+        if (stats) stats->recordError();
+        return sendResponse(fd, 1, (uint32_t)(secondsSince(start) * 1e6), message.data(), message.size());
+    };
+
+    if (op == Stats) {
+        std::string report = statsReport();
+        return sendResponse(fd, 0, 0, report.data(), report.size());
+    }
+    if (op != Process && op != ProcessShared) return fail("unknown op " + std::to_string(op), nullptr);
+
+    auto it = graphs.find(name);
+    if (it == graphs.end()) return fail("unknown graph '" + name + "'", nullptr);
+    const ServedGraph& served = it->second;
+    const Graph& graph = *served.graph;
+
+    // evaluation, conversions and encoders may throw (bad input, out of
+    // memory); that fails this request, not the connection or the server
+    try {
+        LatencyStats::Sample sample;
+        if (op == ProcessShared) {
+            SharedImageRequest request;
+            if (payload.size() != sizeof(request)) return fail("bad shared image request", served.stats.get());
+            std::memcpy(&request, payload.data(), sizeof(request));
+
+            SharedImageDesc reply {};
+            std::string error;
+            if (!processShared(name, served, session, request, reply, error, sample)) {
+                return fail(error, served.stats.get());
+            }
+            sample.total = secondsSince(start);
+            served.stats->record(sample);
+            return sendResponse(fd, 0, (uint32_t)(sample.total * 1e6), &reply, sizeof(reply));
+        }
+
+        cv::Mat image;
+        try {
+            image = prepareSourceImage(cv::imdecode(payload, cv::IMREAD_UNCHANGED), graph.workingFormat, graph.planarLayout);
+        } catch (const cv::Exception&) {
+            image.release();
+        }
+        if (image.empty()) return fail("cannot decode request image", served.stats.get());
+        sample.decode = secondsSince(start);
+
+        auto evaluateStart = Clock::now();
+        ExecutionContext& context = session.contexts[name];
+        context.setSource(served.sourceId, image);
+        graph.evaluate(context);
+        cv::Mat result = context.output(served.outputId);
+        sample.evaluate = secondsSince(evaluateStart);
+        if (result.empty()) return fail("graph produced no output", served.stats.get());
+
+        auto encodeStart = Clock::now();
+        std::vector<uchar> encoded;
+        try {
+            cv::imencode(served.extension, prepareForEncoding(result, served.format), encoded, served.params);
+        } catch (const cv::Exception& e) {
+            return fail(std::string("encode failed: ") + e.what(), served.stats.get());
+        }
+        sample.encode = secondsSince(encodeStart);
+        sample.total = secondsSince(start);
+        served.stats->record(sample);
+
+        return sendResponse(fd, 0, (uint32_t)(sample.total * 1e6), encoded.data(), encoded.size());
+    } catch (const std::exception& e) {
+        session.contexts[name].clearSources(); // may point into a client's segment
+        return fail(std::string("request failed: ") + e.what(), served.stats.get());
+    } catch (...) {
+        session.contexts[name].clearSources();
+        return fail("request failed", served.stats.get());
+    }
+}
+
+bool GraphServer::processShared(const std::string& name, const ServedGraph& served, Session& session,
+                                const SharedImageRequest& request,
+                                SharedImageDesc& reply, std::string& error, LatencyStats::Sample& sample) {
+    const Graph& graph = *served.graph;
+    auto start = Clock::now();
+
+    if (session.fds.empty()) {
+        error = "no shared memory segment attached";
+        return false;
+    }
+    size_t segmentSize = 0;
+    uchar* base = session.segments.map(session.fds.back(), segmentSize);
+    closeAll(session.fds); // the mapping is all we need
+    if (!base) {
+        error = "cannot map segment; it must be a memfd sealed with F_SEAL_SHRINK";
+        return false;
+    }
+    cv::Mat view = sharedImageView(base, segmentSize, request.input);
+    if (view.empty()) {
+        error = "input descriptor does not fit the segment";
+        return false;
+    }
+
+    // read in place; only alpha images are copied, since premultiplying
+    // works in place and must not write into the client's pixels
+    cv::Mat image = prepareSourceImage(view.channels() == 4 ? view.clone() : view, graph.workingFormat, graph.planarLayout);
+    sample.decode = secondsSince(start);
+
+    auto evaluateStart = Clock::now();
+    ExecutionContext& context = session.contexts[name];
+    context.setSource(served.sourceId, image);
+    graph.evaluate(context);
+    cv::Mat result = context.output(served.outputId);
+    context.clearSources(); // the view points into the client's segment
+    sample.evaluate = secondsSince(evaluateStart);
+    if (result.empty()) {
+        error = "graph produced no output";
+        return false;
+    }
+
+    auto encodeStart = Clock::now();
+    int depth = CV_MAT_DEPTH(request.input.type);
+    cv::Mat interleaved = imageChannels(result) == 4 ? prepareForEncoding(result, "TIFF") : toInterleaved(result);
+    cv::Size size = interleaved.size();
+
+    reply.width = size.width;
+    reply.height = size.height;
+    reply.type = CV_MAKETYPE(depth, interleaved.channels());
+    reply.offset = request.outputOffset;
+    reply.stride = (uint64_t)size.width * CV_ELEM_SIZE(reply.type);
+
+    cv::Mat target = sharedImageView(base, segmentSize, reply);
+    if (target.empty() || reply.stride * reply.height > request.outputCapacity) {
+        error = "output region too small for " + std::to_string(size.width) + "x" + std::to_string(size.height);
+        return false;
+    }
+
+    // the one unavoidable copy: straight into the client's memory
+    if (interleaved.depth() == depth) {
+        interleaved.copyTo(target);
+    } else {
+        interleaved.convertTo(target, depth, depthMaxValue(depth) / depthMaxValue(interleaved.depth()));
+    }
+    sample.encode = secondsSince(encodeStart);
+    return true;
+}
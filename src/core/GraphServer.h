@@ -0,0 +1,107 @@
+#pragma once
+#include <atomic>
+#include <list>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Graph.h"
+#include "../utils/LatencyStats.h"
+#include "../utils/SharedMemory.h"
+
+// Headless evaluation daemon on a Unix domain socket. Graphs are loaded from
+// graph files once at startup, their still-image inputs decoded, and then
+// served read-only: every connection evaluates through its own
+// ExecutionContexts, so requests run concurrently against the same warm graph.
+//
+// Wire protocol, all integers uint32 in host byte order; a connection may
+// send any number of requests and gets one response per request, in order:
+//
+//   request:  op, nameLength, name, payloadLength, payload
+//     op 1 PROCESS         name = graph, payload = encoded image (anything imdecode reads)
+//     op 2 STATS           name and payload ignored
+//     op 3 PROCESS_SHARED  name = graph, payload = SharedImageRequest; a memfd
+//                          sealed with F_SEAL_SHRINK must ride along with the
+//                          request (SCM_RIGHTS)
+//   response: status (0 ok, 1 error), serverMicros, payloadLength, payload
+//     PROCESS ok           payload = result, encoded as the graph's Output node format
+//     PROCESS_SHARED ok    payload = SharedImageDesc of the result, written into
+//                          the segment at outputOffset (straight alpha, the
+//                          input's depth, rows packed)
+//     otherwise            payload = text
+//
+// PROCESS_SHARED moves no pixels through the socket: the input is read where
+// the client wrote it and the result lands in the same segment. The client
+// must not touch either region until the response arrives. Segments are
+// mapped once per connection and reused, so clients should recycle a few
+// memfds rather than create one per frame.
+//
+// The request image feeds the graph's first Input node; the result is read
+// from its first Output node.
+class GraphServer {
+public:
+    enum Op : uint32_t { Process = 1, Stats = 2, ProcessShared = 3 };
+
+    struct SharedImageRequest {
+        SharedImageDesc input;
+        uint64_t outputOffset;
+        uint64_t outputCapacity;
+    };
+
+    struct Options {
+        std::string socketPath = "/tmp/node-image-processor.sock";
+        int maxConnections = 64;
+    };
+
+    ~GraphServer();
+
+    // Call before start(). Loads the file and settles its inputs (blocking).
+    bool addGraph(const std::string& name, const std::string& path);
+
+    bool start(const Options& options);
+    void stop();
+
+    // Per-graph latency lines, as returned by the STATS op.
+    std::string statsReport() const;
+
+private:
+    struct ServedGraph {
+        std::shared_ptr<const Graph> graph;
+        int sourceId = 0;
+        int outputId = 0;
+        std::string extension;
+        std::vector<int> params;
+        std::string format;
+        std::unique_ptr<LatencyStats> stats;
+    };
+
+    // per-connection state, only touched by that connection's thread
+    struct Session {
+        std::unordered_map<std::string, ExecutionContext> contexts; // warm buffers per graph
+        SharedSegmentMap segments;
+        std::vector<int> fds; // received with the current request
+    };
+
+    struct Connection {
+        int fd = -1;
+        std::thread thread;
+        std::atomic<bool> done{false};
+    };
+
+    std::unordered_map<std::string, ServedGraph> graphs; // fixed once started
+    Options options;
+    int listenFd = -1;
+    std::thread acceptThread;
+    std::atomic<bool> stopping{false};
+    std::list<std::unique_ptr<Connection>> connections; // accept thread only
+
+    void acceptLoop();
+    void serve(Connection* connection);
+    bool handleRequest(int fd, Session& session);
+    // PROCESS_SHARED body; returns the response status and fills `reply`
+    bool processShared(const std::string& name, const ServedGraph& served, Session& session,
+                       const SharedImageRequest& request, SharedImageDesc& reply, std::string& error,
+                       LatencyStats::Sample& sample);
+    static bool sendResponse(int fd, uint32_t status, uint32_t micros, const void* data, size_t size);
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+
+// Pipeline-wide working depth. Sources convert to it once; every other node
+// keeps whatever depth it receives.
+enum class WorkingFormat { U8, U16, F32 };
+
+inline int formatDepth(WorkingFormat format) {
+    switch (format) {
+        case WorkingFormat::U16: return CV_16U;
+        case WorkingFormat::F32: return CV_32F;
+        default:                 return CV_8U;
+    }
+}
+
+inline const char* formatName(WorkingFormat format) {
+    switch (format) {
+        case WorkingFormat::U16: return "16-bit";
+        case WorkingFormat::F32: return "32-bit float";
+        default:                 return "8-bit";
+    }
+}
+
+// Value representing full intensity for a depth (white).
+inline double depthMaxValue(int depth) {
+    switch (depth) {
+        case CV_8U:  return 255.0;
+        case CV_16U: return 65535.0;
+        case CV_16F:
+        case CV_32F:
+        case CV_64F: return 1.0;
+        default:     return 255.0;
+    }
+}
+
+// Converts between depths, rescaling so full intensity maps to full intensity.
+inline void convertDepth(const cv::Mat& src, cv::Mat& dst, int depth) {
+    if (src.depth() == depth) {
+        if (&src != &dst) dst = src;
+        return;
+    }
+    double scale = depthMaxValue(depth) / depthMaxValue(src.depth());
+    src.convertTo(dst, depth, scale);
+}
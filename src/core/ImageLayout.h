@@ -0,0 +1,65 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// Images normally travel through the graph interleaved (BGRBGR...). With the
+// planar layout enabled, sources emit a 3-D single-channel Mat of size
+// {channels, rows, cols}: each channel is one contiguous plane, so per-channel
+// kernels run over contiguous memory. Conversion happens only at InputNode and
+// OutputNode (and for previews).
+
+inline bool isPlanar(const cv::Mat& m) { return m.dims == 3; }
+
+inline int imageChannels(const cv::Mat& m) { return isPlanar(m) ? m.size[0] : m.channels(); }
+
+inline cv::Size imageSize(const cv::Mat& m) {
+    return isPlanar(m) ? cv::Size(m.size[2], m.size[1]) : m.size();
+}
+
+// 2-D header over plane c. Does not hold a reference: valid while m is alive.
+inline cv::Mat planeView(const cv::Mat& m, int c) {
+    return cv::Mat(m.size[1], m.size[2], m.type(), const_cast<uchar*>(m.ptr(c)), m.step[1]);
+}
+
+// Allocates dst as a planar image with the given plane size, channels and depth.
+inline void createPlanar(cv::Mat& dst, cv::Size size, int channels, int depth) {
+    int sizes[3] = { channels, size.height, size.width };
+    dst.create(3, sizes, CV_MAKETYPE(depth, 1));
+}
+
+// Allocates dst as a one-channel image of src's size, depth and layout (for
+// masks such as edges and thresholds) and returns a 2-D view to write into.
+inline cv::Mat createSingleChannel(const cv::Mat& src, cv::Mat& dst) {
+    if (isPlanar(src)) {
+        createPlanar(dst, imageSize(src), 1, src.depth());
+        return planeView(dst, 0);
+    }
+    dst.create(src.size(), CV_MAKETYPE(src.depth(), 1));
+    return dst;
+}
+
+inline std::vector<cv::Mat> planeViews(const cv::Mat& m) {
+    std::vector<cv::Mat> planes;
+    for (int c = 0; c < imageChannels(m); ++c) {
+        planes.push_back(planeView(m, c));
+    }
+    return planes;
+}
+
+inline cv::Mat toPlanar(const cv::Mat& src) {
+    if (src.empty() || isPlanar(src)) return src;
+
+    cv::Mat dst;
+    createPlanar(dst, src.size(), src.channels(), src.depth());
+    std::vector<cv::Mat> planes = planeViews(dst);
+    cv::split(src, planes);
+    return dst;
+}
+
+inline cv::Mat toInterleaved(const cv::Mat& src) {
+    if (src.empty() || !isPlanar(src)) return src;
+
+    cv::Mat dst;
+    cv::merge(planeViews(src), dst);
+    return dst;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+#include "Node.h"
+#include "../utils/IntegralImage.h"
+
+// Summed-area tables of node outputs, keyed by output attribute and table
+// kind, and built on first request. Every consumer of the same output gets the same table, and
+// the graph keeps it across evaluations until the producer's version (or
+// buffer) changes, so a consumer whose own parameters change reuses it too.
+class IntegralCache {
+    struct Entry {
+        uint64_t version = 0;
+        const uchar* data = nullptr;
+        IntegralImagePtr integral;
+        bool used = false;
+    };
+    std::map<std::pair<int, IntegralKind>, Entry> entries;
+
+public:
+    IntegralImagePtr get(int attr, IntegralKind kind, uint64_t version, const cv::Mat& image) {
+        if (image.empty()) return nullptr;
+
+        Entry& entry = entries[{ attr, kind }];
+        entry.used = true;
+        if (!entry.integral || entry.version != version || entry.data != image.data) {
+            entry.integral = std::make_shared<const IntegralImage>(
+                kind == IntegralKind::Gray ? IntegralImage::computeGray(image) : IntegralImage::compute(image));
+            entry.version = version;
+            entry.data = image.data;
+        }
+        return entry.integral;
+    }
+
+    // Keeps the entry alive through sweep() without building it (its
+    // consumers were up to date and did not need it this time).
+    void touch(int attr, IntegralKind kind) {
+        auto it = entries.find({ attr, kind });
+        if (it != entries.end()) it->second.used = true;
+    }
+
+    // Drops tables nobody asked for or touched since the last sweep.
+    void sweep() {
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (!it->second.used) {
+                it = entries.erase(it);
+            } else {
+                it->second.used = false;
+                ++it;
+            }
+        }
+    }
+
+    void clear() { entries.clear(); }
+};
@@ -1,20 +1,148 @@
 #pragma once
 #include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cmath>
+#include <memory>
 #include <string>
 #include <vector>
+#include "ImageFormat.h"
+#include "ImageLayout.h"
+
+// Attribute ids are encoded as id * 1000 + index. Input ports use indices
+// [0, kOutputPortBase), output ports use kOutputPortBase + port.
+constexpr int kAttrStride = 1000;
+constexpr int kOutputPortBase = 100;
+
+inline int inputAttrId(int nodeId, int index) { return nodeId * kAttrStride + index; }
+inline int outputAttrId(int nodeId, int port) { return nodeId * kAttrStride + kOutputPortBase + port; }
+inline int attrNode(int attr) { return attr / kAttrStride; }
+inline bool isOutputAttr(int attr) { return attr % kAttrStride >= kOutputPortBase; }
+inline int attrIndex(int attr) {
+    int index = attr % kAttrStride;
+    return index >= kOutputPortBase ? index - kOutputPortBase : index;
+}
+
+struct IntegralImage;
+using IntegralImagePtr = std::shared_ptr<const IntegralImage>;
+
+// Which summed-area table a node wants of an input: none, one per channel,
+// or a single one of the luminance.
+enum class IntegralKind { None, Channels, Gray };
 
 class Node {
+protected:
+    std::vector<bool> requestedOutputs;
+    std::vector<IntegralImagePtr> inputIntegrals;
+    WorkingFormat workingFormat = WorkingFormat::U8;
+    bool planarLayout = false;
+    int proxyScale = 1;
+
+    // For compute() in nodes that can pass their input straight through: a
+    // context has no memory of that, so an output buffer is only reused when
+    // this node allocated it and nothing else refers to it. An alias of an
+    // earlier input, or a view of foreign memory, is dropped before writing.
+    static void releaseUnlessExclusive(cv::Mat& output) {
+        if (!output.u || output.u->refcount > 1) output.release();
+    }
+
 public:
     int id;
     std::string name;
 
+    // Bumped whenever getOutput() may have changed. The graph re-processes a
+    // node only when it is dirty or one of its inputs' versions moved, so a
+    // change re-evaluates just the affected downstream sub-graph. Source nodes
+    // (no inputs) are polled every evaluation and bump their own version.
+    uint64_t version = 0;
+    bool dirty = true;
+
+    void markDirty() { dirty = true; }
+
     Node(int id, const std::string& name) : id(id), name(name) {}
 
     virtual void process() = 0;
-    virtual cv::Mat getOutput() const = 0;
+    virtual cv::Mat getOutput(int port = 0) const = 0;
     virtual void preview() {}
     virtual void renderPropertiesUI() {}
     virtual void setInputs(const std::vector<cv::Mat>&) {}
 
+    // Stateless form of setInputs() + process(): reads only the node's
+    // parameters, so many execution contexts can share one node. `inputs` has
+    // inputCount() entries (empty Mats where unlinked), `outputs` has
+    // max(outputCount(), 1) and keeps the context's buffers between calls.
+    virtual void compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs,
+                         const std::vector<bool>& requested) const = 0;
+
+    // Box-type filters (box blur, adaptive threshold, local means) read window
+    // sums from a summed-area table of their input. A node names the kind of
+    // table it wants per input port; the graph builds each upstream output's
+    // table of that kind once and shares it between all consumers (see
+    // core/IntegralCache.h). `integrals` has inputCount() entries, null where
+    // not wanted or unlinked.
+    virtual IntegralKind inputIntegralKind(int) const { return IntegralKind::None; }
+    virtual void computeWithIntegrals(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs,
+                                      const std::vector<bool>& requested,
+                                      const std::vector<IntegralImagePtr>&) const {
+        compute(inputs, outputs, requested);
+    }
+
+    // A fresh node with the same id, name and parameters but none of the
+    // images, GL textures, file watches or background work. Used to build
+    // worker graphs.
+    virtual std::shared_ptr<Node> clone() const = 0;
+
+    // Stable type key used by graph files (see core/GraphFile.h).
+    virtual const char* typeName() const = 0;
+    // Parameters only, no images: written into / read from the node's map
+    // in a graph file. Missing keys keep their current value.
+    virtual void writeParameters(cv::FileStorage&) const {}
+    virtual void readParameters(const cv::FileNode&) {}
+
+    virtual int inputCount() const { return 1; }
+    virtual int outputCount() const { return 1; }
+    virtual const char* inputName(int) const { return "In"; }
+    virtual const char* outputName(int) const { return "Out"; }
+
+    // Rows of context above and below each output row this node reads.
+    // Strip-based evaluation pads every strip by the halos along its chain.
+    virtual int haloRows() const { return 0; }
+
+    // False when an output row can depend on input rows beyond any fixed
+    // halo (geometric warps, statistics of the whole image): such a node
+    // gives wrong results on strips, so TiledRenderer refuses the graph.
+    virtual bool isStreamable() const { return true; }
+
+    // Blocks until background work that feeds the next process() (e.g. an
+    // image decode) has finished. Used by renders that must not skip frames.
+    virtual void waitForPendingWork() {}
+
+    // Set by the graph before process(): which output ports have a consumer.
+    // Multi-output nodes skip computing ports nobody is linked to.
+    void setRequestedOutputs(const std::vector<bool>& requested) { requestedOutputs = requested; }
+    // Radii and sizes are set in full-resolution pixels; process() on a proxy
+    // preview works in 1/proxyScale of that, but never below one pixel.
+    // Zero or negative values ("unset") are passed through.
+    int proxyPixels(int pixels) const {
+        return pixels > 0 ? std::max(1, (int)std::lround((double)pixels / proxyScale)) : pixels;
+    }
+
+    bool isOutputRequested(int port) const {
+        return port >= 0 && port < (int)requestedOutputs.size() && requestedOutputs[port];
+    }
+
+    // Set by the graph before process(): the tables inputIntegralKind() asked for.
+    void setInputIntegrals(const std::vector<IntegralImagePtr>& integrals) { inputIntegrals = integrals; }
+    IntegralImagePtr inputIntegral(int index) const {
+        return index >= 0 && index < (int)inputIntegrals.size() ? inputIntegrals[index] : nullptr;
+    }
+
+    // Set by the graph before process(). Source nodes convert to this depth.
+    void setWorkingFormat(WorkingFormat format) { workingFormat = format; }
+    // Set by the graph before process(). Source nodes emit planar images when set.
+    void setPlanarLayout(bool planar) { planarLayout = planar; }
+    // Set by the graph before process(). 2, 4 or 8 asks sources for a reduced
+    // resolution preview; 1 means full resolution (always used for renders).
+    void setProxyScale(int scale) { proxyScale = scale; }
+
     virtual ~Node() = default;
-};
\ No newline at end of file
+};
@@ -0,0 +1,97 @@
+#include "SequenceRenderer.h"
+#include "../nodes/SequenceInputNode.h"
+#include "../nodes/OutputNode.h"
+#include <iostream>
+
+SequenceRenderer::~SequenceRenderer() {
+    cancel();
+    wait();
+}
+
+bool SequenceRenderer::start(Graph& graph, const Options& options) {
+    if (running) return false;
+    wait(); // reap the previous run
+
+    SequenceInputNode* source = nullptr;
+    std::vector<OutputNode*> outputs;
+    for (const auto& [id, node] : graph.nodes) {
+        if (auto* sequence = dynamic_cast<SequenceInputNode*>(node.get())) {
+            if (!source && sequence->getFrameCount() > 0) source = sequence;
+        } else if (auto* output = dynamic_cast<OutputNode*>(node.get())) {
+            outputs.push_back(output);
+        }
+    }
+
+    if (!source || outputs.empty()) {
+        std::cerr << "Sequence render needs an opened Sequence Input and an Output node\n";
+        return false;
+    }
+
+    // a private pool: its bounded queue is what caps frames in flight
+    encoders = std::make_unique<EncoderPool>(options.encoderThreads, options.maxInFlight);
+    cancelled = false;
+    jobsSkipped = 0;
+    framesTotal = source->getFrameCount();
+    outputsPerFrame = (int)outputs.size();
+    startTime = std::chrono::steady_clock::now();
+    running = true;
+
+    evaluator = std::thread(&SequenceRenderer::evaluateLoop, this, std::ref(graph), source, outputs);
+    return true;
+}
+
+void SequenceRenderer::cancel() {
+    cancelled = true;
+}
+
+void SequenceRenderer::wait() {
+    if (evaluator.joinable()) evaluator.join();
+}
+
+int SequenceRenderer::getFramesDone() const {
+    int jobsDone = jobsSkipped + (encoders ? encoders->getCompletedCount() : 0);
+    return jobsDone / std::max(outputsPerFrame, 1);
+}
+
+double SequenceRenderer::getFramesPerSecond() const {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return seconds > 0 ? getFramesDone() / seconds : 0.0;
+}
+
+void SequenceRenderer::evaluateLoop(Graph& graph, SequenceInputNode* source, std::vector<OutputNode*> outputs) {
+    // final renders are always full resolution
+    int previewScale = graph.proxyScale;
+    graph.proxyScale = 1;
+
+    // outputs are numbered like the source files, not from zero
+    const int firstFrame = source->getFirstFrame();
+
+    for (int frame = 0; frame < framesTotal && !cancelled; ++frame) {
+        // blocks only if the decoders have fallen behind
+        source->seekFrame(frame);
+        graph.evaluate();
+        if (frame == 0) {
+            // still images elsewhere in the graph may be decoding (or re-decoding
+            // at full resolution); wait for them and evaluate again
+            graph.waitForPendingWork();
+            graph.evaluate();
+        }
+
+        for (OutputNode* output : outputs) {
+            cv::Mat image = output->getOutput();
+            if (image.empty()) {
+                ++jobsSkipped;
+                continue;
+            }
+            // blocks when maxInFlight frames are waiting on the encoders
+            encoders->submit({ output->outputPath(firstFrame + frame), output->getFormat(), output->encodeParams(), image });
+        }
+    }
+
+    encoders->waitIdle();
+    graph.proxyScale = previewScale;
+
+    std::cout << "Rendered " << getFramesDone() << " frames at "
+              << getFramesPerSecond() << " fps\n";
+    running = false;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Graph.h"
+#include "../utils/EncoderPool.h"
+
+class SequenceInputNode;
+class OutputNode;
+
+// Renders every frame of a graph's sequence source through all of its output
+// nodes as a three-stage pipeline:
+//
+//   decode (FramePrefetcher threads) -> evaluate (one thread) -> encode (EncoderPool)
+//
+// Frame k+1 decodes while frame k is evaluated and frame k-1 is written, so
+// throughput approaches the slowest stage instead of the sum of all three.
+// In-flight memory is capped by the prefetch ring on the decode side and by
+// maxInFlight encoded-but-unwritten frames on the encode side.
+//
+// While running, the graph belongs to the render thread: the caller must not
+// evaluate or edit it until isRunning() returns false.
+class SequenceRenderer {
+public:
+    struct Options {
+        int maxInFlight = 8;
+        int encoderThreads = 2;
+    };
+
+    ~SequenceRenderer();
+
+    // Returns false if the graph has no sequence source or no output node.
+    bool start(Graph& graph, const Options& options);
+    void cancel();
+    void wait();
+
+    bool isRunning() const { return running; }
+    int getFramesDone() const;
+    int getFramesTotal() const { return framesTotal; }
+    double getFramesPerSecond() const;
+
+private:
+    std::thread evaluator;
+    std::unique_ptr<EncoderPool> encoders;
+
+    std::atomic<bool> running{false};
+    std::atomic<bool> cancelled{false};
+    std::atomic<int> jobsSkipped{0};
+    std::atomic<int> framesTotal{0};
+    int outputsPerFrame = 1;
+    std::chrono::steady_clock::time_point startTime;
+
+    void evaluateLoop(Graph& graph, SequenceInputNode* source, std::vector<OutputNode*> outputs);
+};
@@ -0,0 +1,138 @@
+#include "TiledRenderer.h"
+#include "../nodes/TiledTiffInputNode.h"
+#include "../nodes/OutputNode.h"
+#include "../utils/EncoderPool.h"
+#include "../utils/SourceImage.h"
+#include "../utils/TiledTiff.h"
+#include <algorithm>
+#include <iostream>
+#include <memory>
+
+TiledRenderer::~TiledRenderer() {
+    cancel();
+    wait();
+}
+
+bool TiledRenderer::start(Graph& graph, const Options& options) {
+    if (running) return false;
+    wait();
+
+    TiledTiffInputNode* input = nullptr;
+    OutputNode* output = nullptr;
+    for (const auto& [id, node] : graph.nodes) {
+        if (auto* in = dynamic_cast<TiledTiffInputNode*>(node.get())) {
+            if (!input) input = in;
+        } else if (auto* out = dynamic_cast<OutputNode*>(node.get())) {
+            if (!output) output = out;
+        }
+    }
+
+    if (!input || !output || output->getFormat() != "TIFF") {
+        std::cerr << "Tiled render needs a Tiled TIFF Input node and an Output node set to TIFF\n";
+        return false;
+    }
+    if (graph.haloRowsBetween(input->id, output->id) < 0) {
+        std::cerr << "Tiled render needs the Output node to be fed from the Tiled TIFF Input node\n";
+        return false;
+    }
+    auto streamed = graph.accumulatedHaloRows(input->id);
+    for (const auto& reached : streamed) {
+        const Node& node = *graph.nodes.at(reached.first);
+        if (!node.isStreamable()) {
+            std::cerr << "Tiled render can't stream through " << node.name << " (" << node.typeName()
+                      << "): its output depends on more than nearby rows\n";
+            return false;
+        }
+    }
+    // a streamed node only sees strips; an input from anywhere else is a whole
+    // image, and nodes like Blend would quietly resize it into every strip
+    for (const Link& link : graph.links) {
+        if (streamed.count(link.toNode) && !streamed.count(link.fromNode)) {
+            const Node& node = *graph.nodes.at(link.toNode);
+            std::cerr << "Tiled render can't stream through " << node.name << " (" << node.typeName()
+                      << "): one of its inputs doesn't come from the Tiled TIFF Input node\n";
+            return false;
+        }
+    }
+
+    cancelled = false;
+    rowsDone = 0;
+    rowsTotal = 0;
+    running = true;
+    worker = std::thread(&TiledRenderer::renderLoop, this, std::ref(graph), input, output,
+                         input->getFilepath(), output->outputPath(), std::max(options.stripRows, 1));
+    return true;
+}
+
+void TiledRenderer::wait() {
+    if (worker.joinable()) worker.join();
+}
+
+void TiledRenderer::renderLoop(Graph& graph, TiledTiffInputNode* input, OutputNode* output,
+                               std::string sourcePath, std::string targetPath, int stripRows) {
+    TiffRegionReader reader(sourcePath);
+    if (!reader.isOpen()) {
+        std::cerr << "Cannot stream " << sourcePath << "\n";
+        running = false;
+        return;
+    }
+
+    const cv::Size size = reader.size();
+    const int halo = graph.haloRowsBetween(input->id, output->id);
+    // every tile of one strip plus its halo stays cached, so the halo rows
+    // shared with the next strip are never decoded twice
+    reader.setCacheTiles(reader.tilesForRows(stripRows + 2 * halo));
+    int previewScale = graph.proxyScale;
+    graph.proxyScale = 1;
+
+    // settle other inputs' loads at full resolution before streaming
+    input->setStreamedImage(cv::Mat());
+    graph.evaluate();
+    graph.waitForPendingWork();
+    rowsTotal = size.height;
+
+    std::unique_ptr<TiffStripWriter> writer;
+    bool ok = true;
+
+    for (int y0 = 0; y0 < size.height && ok && !cancelled; y0 += stripRows) {
+        int y1 = std::min(size.height, y0 + stripRows);
+        int readY0 = std::max(0, y0 - halo);
+        int readY1 = std::min(size.height, y1 + halo);
+
+        cv::Mat strip = reader.readRegion(cv::Rect(0, readY0, size.width, readY1 - readY0));
+        input->setStreamedImage(prepareSourceImage(strip, graph.workingFormat, graph.planarLayout));
+        graph.evaluate();
+
+        cv::Mat result = output->getOutput();
+        if (result.cols != size.width || result.rows != readY1 - readY0) {
+            std::cerr << "Tiled render requires a graph that preserves image size\n";
+            ok = false;
+            break;
+        }
+
+        // drop the halo rows, keep this strip's own rows
+        cv::Mat rows = prepareForEncoding(result.rowRange(y0 - readY0, y1 - readY0), "TIFF");
+        if (!writer) {
+            writer = std::make_unique<TiffStripWriter>(targetPath, size, rows.type());
+            if (!writer->isOpen()) {
+                ok = false;
+                break;
+            }
+        }
+        ok = writer->appendRows(rows);
+        rowsDone = y1;
+    }
+
+    input->endStreaming();
+    graph.proxyScale = previewScale;
+    if (writer) {
+        ok = writer->close() && ok;
+    }
+
+    if (ok && !cancelled) {
+        std::cout << "Wrote " << targetPath << " (" << size.width << " x " << size.height << ")\n";
+    } else {
+        std::cerr << "Tiled render of " << sourcePath << " did not complete\n";
+    }
+    running = false;
+}
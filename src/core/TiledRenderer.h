@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include <thread>
+#include "Graph.h"
+
+class TiledTiffInputNode;
+class OutputNode;
+
+// Streams a TIFF larger than memory through the graph in full-width strips.
+// Each strip is read from the source with a halo of extra rows above and below
+// (Graph::haloRowsBetween), so neighbourhood filters see real context, evaluated,
+// trimmed back to its own rows and appended to a striped output TIFF. Only the
+// tiles touching the current strip are ever decoded.
+//
+// The graph must preserve image size, and every node fed by the source must
+// be streamable (Node::isStreamable). Like SequenceRenderer, the graph belongs
+// to the render thread until isRunning() returns false.
+class TiledRenderer {
+public:
+    struct Options {
+        int stripRows = 512;
+    };
+
+    ~TiledRenderer();
+
+    // Uses the first Tiled TIFF Input node and the first Output node, whose
+    // format must be TIFF. Regular Input nodes decode whole files and are
+    // never streamed.
+    bool start(Graph& graph, const Options& options);
+    void cancel() { cancelled = true; }
+    void wait();
+
+    bool isRunning() const { return running; }
+    int getRowsDone() const { return rowsDone; }
+    int getRowsTotal() const { return rowsTotal; }
+
+private:
+    std::thread worker;
+    std::atomic<bool> running{false};
+    std::atomic<bool> cancelled{false};
+    std::atomic<int> rowsDone{0};
+    std::atomic<int> rowsTotal{0};
+
+    void renderLoop(Graph& graph, TiledTiffInputNode* input, OutputNode* output,
+                    std::string sourcePath, std::string targetPath, int stripRows);
+};
@@ -1,23 +1,83 @@
 #include "imgui.h"
 #include "imnodes.h"
 #include "core/Graph.h"
+#include "core/SequenceRenderer.h"
+#include "core/TiledRenderer.h"
+#include "core/BatchRenderer.h"
+#include "core/GraphFile.h"
+#include "core/GraphServer.h"
 #include "nodes/InputNode.h"
 #include "nodes/OutputNode.h"
 #include "nodes/BrightnessContrastNode.h"
 #include "nodes/BlurNode.h"
+#include "nodes/SplitChannelsNode.h"
+#include "nodes/BlendNode.h"
+#include "nodes/ConvolutionNode.h"
+#include "nodes/EdgeNode.h"
+#include "nodes/ThresholdNode.h"
+#include "nodes/ResizeNode.h"
+#include "nodes/TransformNode.h"
+#include "nodes/ColorConvertNode.h"
+#include "nodes/SequenceInputNode.h"
+#include "nodes/DirectoryInputNode.h"
+#include "nodes/TiledTiffInputNode.h"
 #include <memory>
 
 #include "../backends/imgui_impl_glfw.h"
 #include "../backends/imgui_impl_opengl3.h"
 
 #include <GLFW/glfw3.h>
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <thread>
 
 void glfw_error_callback(int error, const char* description) {
     std::cerr << "GLFW Error " << error << std::endl;
 }
 
-int main() {
+static std::atomic<bool> stopRequested{false};
+
+// Headless mode: demo_app --serve [socket] --graph name=file.yml [--graph ...]
+static int runServer(int argc, char** argv) {
+    GraphServer server;
+    GraphServer::Options options;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--serve") && i + 1 < argc && argv[i + 1][0] != '-') {
+            options.socketPath = argv[++i];
+        } else if (!std::strcmp(argv[i], "--graph") && i + 1 < argc) {
+            std::string spec = argv[++i];
+            size_t eq = spec.find('=');
+            if (eq == std::string::npos || !server.addGraph(spec.substr(0, eq), spec.substr(eq + 1))) {
+                std::cerr << "Bad --graph '" << spec << "' (expected name=file.yml)\n";
+                return 1;
+            }
+        } else if (!std::strcmp(argv[i], "--max-connections") && i + 1 < argc) {
+            options.maxConnections = std::atoi(argv[++i]);
+        }
+    }
+
+    if (!server.start(options)) return 1;
+
+    std::signal(SIGINT, [](int) { stopRequested = true; });
+    std::signal(SIGTERM, [](int) { stopRequested = true; });
+    while (!stopRequested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    server.stop();
+    std::cout << server.statsReport();
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--serve")) return runServer(argc, argv);
+    }
+
     glfwSetErrorCallback(glfw_error_callback);
     if (!glfwInit()) return -1;
 
@@ -80,6 +140,21 @@ int main() {
     // graph.addLink(bcId, 0, outId, 0);
 
     int selectedNodeId = -1;
+    char graphPath[256] = "graph.yml";
+    SequenceRenderer renderer;
+    TiledRenderer tiledRenderer;
+    BatchRenderer batchRenderer;
+
+    auto presentFrame = [&]() {
+        ImGui::Render();
+        int display_w, display_h;
+        glfwGetFramebufferSize(window, &display_w, &display_h);
+        glViewport(0, 0, display_w, display_h);
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        glfwSwapBuffers(window);
+    };
 
     while (!glfwWindowShouldClose(window)) {
         glfwPollEvents();
@@ -88,32 +163,179 @@ int main() {
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
+        if (renderer.isRunning()) {
+            // the render thread owns the graph until it finishes
+            ImGui::Begin("Rendering Sequence");
+            int total = renderer.getFramesTotal();
+            int done = renderer.getFramesDone();
+            ImGui::ProgressBar(total ? (float)done / total : 0.0f, ImVec2(300, 0));
+            ImGui::Text("%d / %d frames, %.1f fps", done, total, renderer.getFramesPerSecond());
+            if (ImGui::Button("Cancel")) {
+                renderer.cancel();
+            }
+            ImGui::End();
+            presentFrame();
+            continue;
+        }
+
+        if (tiledRenderer.isRunning()) {
+            ImGui::Begin("Rendering Tiled TIFF");
+            int total = tiledRenderer.getRowsTotal();
+            int done = tiledRenderer.getRowsDone();
+            ImGui::ProgressBar(total ? (float)done / total : 0.0f, ImVec2(300, 0));
+            ImGui::Text("%d / %d rows", done, total);
+            if (ImGui::Button("Cancel")) {
+                tiledRenderer.cancel();
+            }
+            ImGui::End();
+            presentFrame();
+            continue;
+        }
+
+        if (batchRenderer.isRunning()) {
+            // workers render private clones, so the editor stays usable
+            ImGui::Begin("Rendering Batch");
+            int total = batchRenderer.getFilesTotal();
+            int done = batchRenderer.getFilesDone();
+            ImGui::ProgressBar(total ? (float)done / total : 0.0f, ImVec2(300, 0));
+            ImGui::Text("%d / %d files, %.1f files/s on %d workers", done, total,
+                batchRenderer.getFilesPerSecond(), batchRenderer.getWorkerCount());
+            if (batchRenderer.getFilesFailed() > 0) {
+                ImGui::TextColored(ImVec4(1, 0.3f, 0.3f, 1), "%d failed", batchRenderer.getFilesFailed());
+            }
+            if (ImGui::Button("Cancel")) {
+                batchRenderer.cancel();
+            }
+            ImGui::End();
+        }
+
         ImGui::Begin("Add Node");
 
+        const char* workingFormats[] = { "8-bit", "16-bit", "32-bit float" };
+        int currentWorkingFormat = static_cast<int>(graph.workingFormat);
+        if (ImGui::Combo("Working Format", &currentWorkingFormat, workingFormats, IM_ARRAYSIZE(workingFormats))) {
+            graph.workingFormat = static_cast<WorkingFormat>(currentWorkingFormat);
+        }
+        ImGui::Checkbox("Planar Layout", &graph.planarLayout);
+
+        const char* proxyScales[] = { "Full", "1/2", "1/4", "1/8" };
+        int currentProxy = graph.proxyScale >= 8 ? 3 : graph.proxyScale >= 4 ? 2 : graph.proxyScale >= 2 ? 1 : 0;
+        if (ImGui::Combo("Preview Resolution", &currentProxy, proxyScales, IM_ARRAYSIZE(proxyScales))) {
+            graph.proxyScale = 1 << currentProxy;
+        }
+        ImGui::Separator();
+
         if (ImGui::Button("Input Node")) {
             auto node = std::make_shared<InputNode>(0);
             int id = graph.addNode(node);
             ImNodes::SetNodeEditorSpacePos(id, ImVec2(100, 100));
         }
 
+        if (ImGui::Button("Sequence Input Node")) {
+            auto node = std::make_shared<SequenceInputNode>(0);
+            int id = graph.addNode(node);
+            ImNodes::SetNodeEditorSpacePos(id, ImVec2(100, 300));
+        }
+
+        if (ImGui::Button("Directory Input Node")) {
+            auto node = std::make_shared<DirectoryInputNode>(0);
+            int id = graph.addNode(node);
+            ImNodes::SetNodeEditorSpacePos(id, ImVec2(100, 500));
+        }
+
+        if (ImGui::Button("Tiled TIFF Input Node")) {
+            auto node = std::make_shared<TiledTiffInputNode>(0);
+            int id = graph.addNode(node);
+            ImNodes::SetNodeEditorSpacePos(id, ImVec2(100, 700));
+        }
+
         if (ImGui::Button("Brightness/Contrast Node")) {
             auto node = std::make_shared<BrightnessContrastNode>(0);
             int id = graph.addNode(node);
             ImNodes::SetNodeEditorSpacePos(id, ImVec2(300, 100));
         }
 
+        if (ImGui::Button("Resize Node")) {
+            auto node = std::make_shared<ResizeNode>(0);
+            int id = graph.addNode(node);
+            ImNodes::SetNodeEditorSpacePos(id, ImVec2(300, 900));
+        }
+
+        if (ImGui::Button("Transform Node")) {
+            auto node = std::make_shared<TransformNode>(0);
+            int id = graph.addNode(node);
+            ImNodes::SetNodeEditorSpacePos(id, ImVec2(500, 900));
+        }
+
+        if (ImGui::Button("Color Convert Node")) {
+            auto node = std::make_shared<ColorConvertNode>(0);
+            int id = graph.addNode(node);
+            ImNodes::SetNodeEditorSpacePos(id, ImVec2(500, 700));
+        }
+
         if (ImGui::Button("Blur Node")) {
             auto node = std::make_shared<BlurNode>(0);
             int id = graph.addNode(node);
             ImNodes::SetNodeEditorSpacePos(id, ImVec2(500, 100));
         }
 
+        if (ImGui::Button("Split Channels Node")) {
+            auto node = std::make_shared<SplitChannelsNode>(0);
+            int id = graph.addNode(node);
+            ImNodes::SetNodeEditorSpacePos(id, ImVec2(500, 300));
+        }
+
+        if (ImGui::Button("Blend Node")) {
+            auto node = std::make_shared<BlendNode>(0);
+            int id = graph.addNode(node);
+            ImNodes::SetNodeEditorSpacePos(id, ImVec2(500, 500));
+        }
+
+        if (ImGui::Button("Convolution Node")) {
+            auto node = std::make_shared<ConvolutionNode>(0);
+            int id = graph.addNode(node);
+            ImNodes::SetNodeEditorSpacePos(id, ImVec2(300, 300));
+        }
+
+        if (ImGui::Button("Edge Detect Node")) {
+            auto node = std::make_shared<EdgeNode>(0);
+            int id = graph.addNode(node);
+            ImNodes::SetNodeEditorSpacePos(id, ImVec2(300, 500));
+        }
+
+        if (ImGui::Button("Threshold Node")) {
+            auto node = std::make_shared<ThresholdNode>(0);
+            int id = graph.addNode(node);
+            ImNodes::SetNodeEditorSpacePos(id, ImVec2(300, 700));
+        }
+
         if (ImGui::Button("Output Node")) {
             auto node = std::make_shared<OutputNode>(0);
             int id = graph.addNode(node);
             ImNodes::SetNodeEditorSpacePos(id, ImVec2(700, 100));
         }
 
+        ImGui::Separator();
+        ImGui::InputText("Graph File", graphPath, sizeof(graphPath));
+        if (ImGui::Button("Save Graph")) {
+            saveGraph(graph, graphPath);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Load Graph") && !batchRenderer.isRunning()) {
+            if (loadGraph(graphPath, graph)) selectedNodeId = -1;
+        }
+
+        ImGui::Separator();
+        if (ImGui::Button("Render Sequence")) {
+            renderer.start(graph, SequenceRenderer::Options());
+        }
+        if (ImGui::Button("Render Tiled TIFF")) {
+            tiledRenderer.start(graph, TiledRenderer::Options());
+        }
+        if (ImGui::Button("Render Batch") && !batchRenderer.isRunning()) {
+            batchRenderer.start(graph, BatchRenderer::Options());
+        }
+
         ImGui::End();
 
         graph.evaluate();
@@ -141,20 +363,14 @@ int main() {
 
             node->preview();
 
-            if (dynamic_cast<InputNode*>(node.get())) {
-                ImNodes::BeginOutputAttribute(id * 1000 + 0);
-                ImGui::Text("Output");
-                ImNodes::EndOutputAttribute();
-            } else if (dynamic_cast<OutputNode*>(node.get())) {
-                ImNodes::BeginInputAttribute(id * 1000 + 0);
-                ImGui::Text("Input");
-                ImNodes::EndInputAttribute();
-            } else {
-                ImNodes::BeginInputAttribute(id * 1000 + 0);
-                ImGui::Text("In");
+            for (int i = 0; i < node->inputCount(); ++i) {
+                ImNodes::BeginInputAttribute(inputAttrId(id, i));
+                ImGui::Text("%s", node->inputName(i));
                 ImNodes::EndInputAttribute();
-                ImNodes::BeginOutputAttribute(id * 1000 + 1);
-                ImGui::Text("Out");
+            }
+            for (int port = 0; port < node->outputCount(); ++port) {
+                ImNodes::BeginOutputAttribute(outputAttrId(id, port));
+                ImGui::Text("%s", node->outputName(port));
                 ImNodes::EndOutputAttribute();
             }
 
@@ -183,10 +399,10 @@ int main() {
         int start_attr, end_attr;
         if (ImNodes::IsLinkCreated(&start_attr, &end_attr)) {
             int fromAttr = start_attr, toAttr = end_attr;
-            if (fromAttr % 1000 < toAttr % 1000) std::swap(fromAttr, toAttr);
+            if (!isOutputAttr(fromAttr)) std::swap(fromAttr, toAttr);
 
-            int fromNode = fromAttr / 1000;
-            int toNode = toAttr / 1000;
+            int fromNode = attrNode(fromAttr);
+            int toNode = attrNode(toAttr);
 
             bool addLink = true;
 
@@ -202,19 +418,19 @@ int main() {
                 }
             }
             
-            int inputCount = 0; // assumes input is <= 1, change for blend node
+            int inputCount = 0; // each input port takes at most one link
             for (const auto& link : graph.getInputLinks(toNode)) {
                 if (link.toAttr == toAttr) {
                     ++inputCount;
                 }
             }
             if (inputCount > 0) {
-                std::cerr << "Only one input allowed for this node\n";
+                std::cerr << "Only one link allowed per input port\n";
                 addLink = false;
             }
             
             if (addLink) {
-                graph.addLink(fromNode, fromAttr % 1000, toNode, toAttr % 1000);
+                graph.addLink(fromNode, attrIndex(fromAttr), toNode, attrIndex(toAttr));
             }
         }
 
@@ -241,16 +457,16 @@ int main() {
         }
         ImGui::End();
 
-        ImGui::Render();
-        int display_w, display_h;
-        glfwGetFramebufferSize(window, &display_w, &display_h);
-        glViewport(0, 0, display_w, display_h);
-        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-        glfwSwapBuffers(window);
+        presentFrame();
     }
 
+    renderer.cancel();
+    renderer.wait();
+    tiledRenderer.cancel();
+    tiledRenderer.wait();
+    batchRenderer.cancel();
+    batchRenderer.wait();
+
     ImNodes::DestroyContext();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
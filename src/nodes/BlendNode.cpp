@@ -0,0 +1,176 @@
+#include "BlendNode.h"
+#include "../utils/TextureUtils.h"
+#include "imgui.h"
+#include <algorithm>
+
+static const char* kModeNames[] = { "Normal", "Multiply", "Screen", "Overlay", "Add", "Difference" };
+
+BlendNode::BlendNode(int id, const std::string& name) : Node(id, name) {}
+
+std::shared_ptr<Node> BlendNode::clone() const {
+    auto copy = std::make_shared<BlendNode>(id, name);
+    copy->mode = mode;
+    copy->opacity = opacity;
+    return copy;
+}
+
+void BlendNode::writeParameters(cv::FileStorage& fs) const {
+    fs << "mode" << (int)mode << "opacity" << opacity;
+}
+
+void BlendNode::readParameters(const cv::FileNode& node) {
+    int modeIndex = (int)mode;
+    cv::read(node["mode"], modeIndex, modeIndex);
+    mode = static_cast<BlendMode>(std::clamp(modeIndex, 0, (int)IM_ARRAYSIZE(kModeNames) - 1));
+    cv::read(node["opacity"], opacity, opacity);
+}
+
+const char* BlendNode::inputName(int index) const {
+    static const char* names[] = { "Base", "Blend", "Mask" };
+    return index >= 0 && index < 3 ? names[index] : "In";
+}
+
+void BlendNode::setInputs(const std::vector<cv::Mat>& input) {
+    baseImage = input.size() > 0 ? input[0] : cv::Mat();
+    blendImage = input.size() > 1 ? input[1] : cv::Mat();
+    maskImage = input.size() > 2 ? input[2] : cv::Mat();
+}
+
+// Brings an input to the base's size, depth, layout and channel count. Inputs
+// that already match (the normal case) pass through without a copy.
+static cv::Mat conform(const cv::Mat& image, cv::Size size, int depth, int channels, bool planar) {
+    if (imageSize(image) == size && image.depth() == depth && imageChannels(image) == channels &&
+        isPlanar(image) == planar) {
+        return image;
+    }
+
+    cv::Mat m = toInterleaved(image);
+    if (m.size() != size) {
+        cv::resize(m, m, size, 0, 0, cv::INTER_LINEAR);
+    }
+    convertDepth(m, m, depth);
+    if (m.channels() != channels) {
+        int from = m.channels();
+        int code = channels == 1 ? (from == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY) :
+                   channels == 3 ? (from == 4 ? cv::COLOR_BGRA2BGR : cv::COLOR_GRAY2BGR) :
+                                   (from == 1 ? cv::COLOR_GRAY2BGRA : cv::COLOR_BGR2BGRA); // opaque alpha
+        cv::cvtColor(m, m, code);
+    }
+    cv::Mat result = planar ? toPlanar(m) : m;
+    if (result.data == image.data) {
+        result = result.clone(); // callers may blend into the result in place
+    }
+    return result;
+}
+
+bool BlendNode::apply(const cv::Mat& base, const cv::Mat& blend, const cv::Mat& mask, cv::Mat& output) const {
+    if (output.u && (output.u == base.u || output.u == blend.u)) {
+        output.release(); // never write through a buffer shared with an input
+    }
+    if (base.empty()) {
+        output.release();
+        return true;
+    }
+    if (blend.empty()) {
+        output = base;
+        return false;
+    }
+
+    cv::Size size = imageSize(base);
+    int depth = base.depth();
+    bool planar = isPlanar(base);
+    int channels = std::max(imageChannels(base), imageChannels(blend));
+
+    cv::Mat b = conform(base, size, depth, channels, planar);
+    cv::Mat s = conform(blend, size, depth, channels, planar);
+    cv::Mat m = mask.empty() ? cv::Mat() : conform(mask, size, depth, 1, false);
+
+    // a converted base is already a private buffer: composite into it in place
+    cv::Mat dst;
+    if (b.data != base.data) {
+        dst = b;
+    } else if (planar) {
+        createPlanar(output, size, channels, depth);
+        dst = output;
+    } else {
+        output.create(size, CV_MAKETYPE(depth, channels));
+        dst = output;
+    }
+
+    bool handled = dispatchPixelType(depth, channels, [&](auto pixel) {
+        using P = decltype(pixel);
+        blendKernel<typename P::Type, P::channels>(b, s, m, dst, mode, opacity);
+    });
+    if (!handled) {
+        // depths without a kernel (e.g. 16F): plain opacity mix
+        cv::addWeighted(b, 1.0 - opacity, s, opacity, 0.0, dst);
+    }
+    output = dst;
+    return true;
+}
+
+void BlendNode::process() {
+    if (outputIsInput) {
+        outputImage.release(); // still an earlier base; don't composite into it
+    }
+    outputIsInput = !apply(baseImage, blendImage, maskImage, outputImage);
+    textureDirty = true;
+}
+
+void BlendNode::compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>&) const {
+    releaseUnlessExclusive(outputs[0]);
+    apply(inputs[0], inputs[1], inputs[2], outputs[0]);
+}
+
+cv::Mat BlendNode::getOutput(int) const {
+    return outputImage;
+}
+
+void BlendNode::preview() {
+    if (outputImage.empty()) {
+        ImGui::Text("No output");
+        return;
+    }
+
+    if (textureDirty) {
+        if (textureID) glDeleteTextures(1, &textureID);
+        textureID = matToTexture(outputImage);
+        textureDirty = false;
+    }
+
+    if (textureID && glIsTexture(textureID)) {
+        ImGui::Text("Preview:");
+        ImGui::Image((ImTextureID)(intptr_t)textureID, ImVec2(128, 128), ImVec2(1, 0), ImVec2(0, 1));
+    }
+}
+
+void BlendNode::renderPropertiesUI() {
+    ImGui::Text("Blend");
+
+    bool updated = false;
+
+    int modeIndex = (int)mode;
+    if (ImGui::Combo("Mode", &modeIndex, kModeNames, IM_ARRAYSIZE(kModeNames))) {
+        mode = static_cast<BlendMode>(modeIndex);
+        updated = true;
+    }
+
+    updated |= ImGui::SliderFloat("Opacity", &opacity, 0.0f, 1.0f);
+    ImGui::SameLine();
+    if (ImGui::Button("Reset##Opacity")) {
+        opacity = 1.0f;
+        updated = true;
+    }
+
+    if (baseImage.empty()) {
+        ImGui::Text("Connect a base image.");
+    } else if (blendImage.empty()) {
+        ImGui::Text("No blend input: base passes through.");
+    } else if (!maskImage.empty()) {
+        ImGui::TextDisabled("Mask scales opacity per pixel");
+    }
+
+    if (updated) {
+        markDirty();
+    }
+}
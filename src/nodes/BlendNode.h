@@ -0,0 +1,40 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include "../core/Node.h"
+#include "../utils/BlendKernels.h"
+#include <GL/gl.h>
+#include <vector>
+
+class BlendNode : public Node {
+private:
+    cv::Mat baseImage, blendImage, maskImage, outputImage;
+    GLuint textureID = 0;
+    bool textureDirty = false;
+    bool outputIsInput = false; // the last process() passed its base through
+
+    BlendMode mode = BlendMode::Normal;
+    float opacity = 1.0f;
+
+    // False when output is just base, passed through.
+    bool apply(const cv::Mat& base, const cv::Mat& blend, const cv::Mat& mask, cv::Mat& output) const;
+
+public:
+    BlendNode(int id, const std::string& name = "Blend");
+
+    void setInputs(const std::vector<cv::Mat>& input) override;
+    void process() override;
+    void compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>& requested) const override;
+    std::shared_ptr<Node> clone() const override;
+    const char* typeName() const override { return "Blend"; }
+    void writeParameters(cv::FileStorage& fs) const override;
+    void readParameters(const cv::FileNode& node) override;
+    cv::Mat getOutput(int port = 0) const override;
+    int inputCount() const override { return 3; }
+    const char* inputName(int index) const override;
+    void preview() override;
+    void renderPropertiesUI() override;
+
+    ~BlendNode() override {
+        if (textureID) glDeleteTextures(1, &textureID);
+    }
+};
@@ -1,10 +1,29 @@
 #include "BlurNode.h"
 #include "../utils/TextureUtils.h"
+#include "../utils/IntegralImage.h"
 #include "imgui.h"
 #include <iostream>
 
 BlurNode::BlurNode(int id, const std::string& name) : Node(id, name) {}
 
+std::shared_ptr<Node> BlurNode::clone() const {
+    auto copy = std::make_shared<BlurNode>(id, name);
+    copy->blurRadius = blurRadius;
+    copy->directional = directional;
+    copy->box = box;
+    return copy;
+}
+
+void BlurNode::writeParameters(cv::FileStorage& fs) const {
+    fs << "blurRadius" << blurRadius << "directional" << (int)directional << "box" << (int)box;
+}
+
+void BlurNode::readParameters(const cv::FileNode& node) {
+    cv::read(node["blurRadius"], blurRadius, blurRadius);
+    cv::read(node["directional"], directional, directional);
+    cv::read(node["box"], box, box);
+}
+
 void BlurNode::setInputs(const std::vector<cv::Mat>& input) {
     if (!input.empty()) {
         inputImage = input[0].clone();
@@ -13,25 +32,52 @@ void BlurNode::setInputs(const std::vector<cv::Mat>& input) {
     }
 }
 
-void BlurNode::process() {
-    if (inputImage.empty()) {
-        outputImage.release();
-        if (textureID) {
-            glDeleteTextures(1, &textureID);
-            textureID = 0;
-        }
+void BlurNode::apply(const cv::Mat& input, cv::Mat& output, IntegralImagePtr sums, int radius) const {
+    if (input.empty()) {
+        output.release();
         return;
     }
 
-    int ksize = blurRadius * 2 + 1;
-    if (directional) {
-        cv::GaussianBlur(inputImage, outputImage, cv::Size(ksize, 1), 0);
+    if (box) {
+        // O(1) per pixel whatever the radius; the table may be shared with
+        // other consumers of the same input
+        bool handled = dispatchPixelType(input.depth(), imageChannels(input), [&](auto pixel) {
+            using P = decltype(pixel);
+            if (!sums) sums = std::make_shared<const IntegralImage>(IntegralImage::compute(input));
+            boxFilterKernel<typename P::Type, P::channels>(*sums, output, radius, directional ? 0 : radius, isPlanar(input));
+        });
+        if (handled) return;
+    }
+
+    int ksize = radius * 2 + 1;
+    cv::Size kernel = directional ? cv::Size(ksize, 1) : cv::Size(ksize, ksize);
+
+    if (isPlanar(input)) {
+        // blur each contiguous plane straight into the matching output plane
+        createPlanar(output, imageSize(input), imageChannels(input), input.depth());
+        for (int c = 0; c < imageChannels(input); ++c) {
+            cv::Mat dst = planeView(output, c);
+            cv::GaussianBlur(planeView(input, c), dst, kernel, 0);
+        }
     } else {
-        cv::GaussianBlur(inputImage, outputImage, cv::Size(ksize, ksize), 0);
+        cv::GaussianBlur(input, output, kernel, 0);
     }
 }
 
-cv::Mat BlurNode::getOutput() const {
+void BlurNode::process() {
+    apply(inputImage, outputImage, inputIntegral(0), proxyPixels(blurRadius));
+}
+
+void BlurNode::compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>&) const {
+    apply(inputs[0], outputs[0], nullptr, blurRadius);
+}
+
+void BlurNode::computeWithIntegrals(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs,
+                                    const std::vector<bool>&, const std::vector<IntegralImagePtr>& integrals) const {
+    apply(inputs[0], outputs[0], integrals[0], blurRadius);
+}
+
+cv::Mat BlurNode::getOutput(int) const {
     return outputImage;
 }
 
@@ -57,14 +103,16 @@ void BlurNode::renderPropertiesUI() {
 
     updated |= ImGui::SliderInt("Radius", &blurRadius, 1, 20);
     updated |= ImGui::Checkbox("Directional (Horizontal Only)", &directional);
+    updated |= ImGui::Checkbox("Box (Summed-Area Table)", &box);
 
     if (ImGui::Button("Reset")) {
         blurRadius = 5;
         directional = false;
+        box = false;
         updated = true;
     }
 
     if (updated) {
-        process();
+        markDirty();
     }
 }
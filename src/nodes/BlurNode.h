@@ -10,15 +10,29 @@ private:
 
     int blurRadius = 5;
     bool directional = false; // false = uniform, true = horizontal only
+    bool box = false;         // box mean from a summed-area table instead of Gaussian
+
+    // sums: the input's summed-area table if the graph shared one; radius is
+    // blurRadius at the input's resolution
+    void apply(const cv::Mat& input, cv::Mat& output, IntegralImagePtr sums, int radius) const;
 
 public:
     BlurNode(int id, const std::string& name = "Blur");
 
     void setInputs(const std::vector<cv::Mat>& input) override;
     void process() override;
-    cv::Mat getOutput() const override;
+    void compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>& requested) const override;
+    IntegralKind inputIntegralKind(int) const override { return box ? IntegralKind::Channels : IntegralKind::None; }
+    void computeWithIntegrals(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs,
+                              const std::vector<bool>& requested, const std::vector<IntegralImagePtr>& integrals) const override;
+    std::shared_ptr<Node> clone() const override;
+    const char* typeName() const override { return "Blur"; }
+    void writeParameters(cv::FileStorage& fs) const override;
+    void readParameters(const cv::FileNode& node) override;
+    cv::Mat getOutput(int port = 0) const override;
     void preview() override;
     void renderPropertiesUI() override;
+    int haloRows() const override { return directional ? 0 : blurRadius; }
 
     ~BlurNode() override {
         if (textureID) glDeleteTextures(1, &textureID);
@@ -2,18 +2,67 @@
 #include <opencv2/imgcodecs.hpp>
 #include <iostream>
 #include "../utils/TextureUtils.h"
+#include "../utils/PixelKernels.h"
 #include "imgui.h"
 #include <vector>
 
 BrightnessContrastNode::BrightnessContrastNode(int id, const std::string& name) : Node(id, name) {}
 
-void BrightnessContrastNode::process() {
-    if (inputImage.empty()) { // if there's no input
+std::shared_ptr<Node> BrightnessContrastNode::clone() const {
+    auto copy = std::make_shared<BrightnessContrastNode>(id, name);
+    copy->brightness = brightness;
+    copy->contrast = contrast;
+    return copy;
+}
+
+void BrightnessContrastNode::writeParameters(cv::FileStorage& fs) const {
+    fs << "brightness" << brightness << "contrast" << contrast;
+}
+
+void BrightnessContrastNode::readParameters(const cv::FileNode& node) {
+    cv::read(node["brightness"], brightness, brightness);
+    cv::read(node["contrast"], contrast, contrast);
+}
+
+void BrightnessContrastNode::apply(const cv::Mat& input, cv::Mat& output) const {
+    if (input.empty()) { // if there's no input
         // std::cerr << "BrightnessContrastNode: No input image.\n";
+        output.release();
         return;
     }
-    outputImage = inputImage.clone();
-    outputImage.convertTo(outputImage, -1, contrast, brightness);
+    // brightness is expressed in 8-bit units regardless of working depth
+    float offset = brightness * (float)depthMaxValue(input.depth()) / 255.0f;
+
+    bool planar = isPlanar(input);
+    if (imageChannels(input) == 4) {
+        bool premultiplied = dispatchPixelType(input.depth(), 1, [&](auto pixel) {
+            affinePremultipliedKernel<typename decltype(pixel)::Type>(input, output, contrast, offset);
+        });
+        if (premultiplied) return;
+    }
+
+    bool handled = dispatchPixelType(input.depth(), imageChannels(input), [&](auto pixel) {
+        using P = decltype(pixel);
+        std::array<float, P::channels> alpha, beta;
+        alpha.fill(contrast);
+        beta.fill(offset);
+        if (planar) {
+            applyAffinePlanar<typename P::Type, P::channels>(input, output, alpha, beta);
+        } else {
+            applyAffine<typename P::Type, P::channels>(input, output, alpha, beta);
+        }
+    });
+    if (!handled) {
+        input.convertTo(output, -1, contrast, offset);
+    }
+}
+
+void BrightnessContrastNode::process() {
+    apply(inputImage, outputImage);
+}
+
+void BrightnessContrastNode::compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>&) const {
+    apply(inputs[0], outputs[0]);
 }
 
 void BrightnessContrastNode::preview() {
@@ -60,7 +109,7 @@ void BrightnessContrastNode::renderPropertiesUI() {
     }
 
     if (updated) {
-        process();
+        markDirty();
     }
 }
 
@@ -72,6 +121,6 @@ void BrightnessContrastNode::setInputs(const std::vector<cv::Mat>& input) {
     }
 }
 
-cv::Mat BrightnessContrastNode::getOutput() const {
+cv::Mat BrightnessContrastNode::getOutput(int) const {
     return outputImage;
 }
\ No newline at end of file
@@ -12,12 +12,19 @@ private:
     float brightness = 0;
     float contrast = 1;
 
+    void apply(const cv::Mat& input, cv::Mat& output) const;
+
 public:
     BrightnessContrastNode(int id, const std::string& name = "Brightness/Contrast");
 
     void setInputs(const std::vector<cv::Mat>& input) override;
     void process() override;
-    cv::Mat getOutput() const override;
+    void compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>& requested) const override;
+    std::shared_ptr<Node> clone() const override;
+    const char* typeName() const override { return "BrightnessContrast"; }
+    void writeParameters(cv::FileStorage& fs) const override;
+    void readParameters(const cv::FileNode& node) override;
+    cv::Mat getOutput(int port = 0) const override;
     GLuint getTextureID() const { return textureID; }
     void preview() override;
     void renderPropertiesUI() override;
@@ -0,0 +1,231 @@
+#include "ColorConvertNode.h"
+#include "../utils/TextureUtils.h"
+#include "../utils/ColorKernels.h"
+#include "imgui.h"
+#include <algorithm>
+
+static const char* kConversionNames[] = {
+    "sRGB -> Linear", "Linear -> sRGB",
+    "BGR -> HSV", "HSV -> BGR",
+    "BGR -> Lab", "Lab -> BGR",
+    "BGR -> YCbCr", "YCbCr -> BGR",
+    "Grayscale"
+};
+
+// Natural channel ranges of the float encodings, used to spread 16-bit
+// HSV / Lab over the full 0..65535 range.
+struct ChannelRanges {
+    cv::Vec3f low, high;
+};
+static const ChannelRanges kHsvRanges { { 0, 0, 0 }, { 360, 1, 1 } };
+static const ChannelRanges kLabRanges { { 0, -128, -128 }, { 100, 127, 127 } };
+
+// value = low + v16 / 65535 * (high - low), per channel, or the inverse.
+static void rescale16(const cv::Mat& src, cv::Mat& dst, const ChannelRanges& ranges, bool toFloat) {
+    cv::Matx34f m = cv::Matx34f::zeros();
+    for (int c = 0; c < 3; ++c) {
+        float span = ranges.high[c] - ranges.low[c];
+        if (toFloat) {
+            m(c, c) = span / 65535.0f;
+            m(c, 3) = ranges.low[c];
+        } else {
+            m(c, c) = 65535.0f / span;
+            m(c, 3) = -ranges.low[c] * 65535.0f / span;
+        }
+    }
+    cv::Mat floats;
+    src.convertTo(floats, CV_32F);
+    if (toFloat) {
+        cv::transform(floats, dst, m);
+    } else {
+        cv::transform(floats, floats, m);
+        floats.convertTo(dst, CV_16U);
+    }
+}
+
+ColorConvertNode::ColorConvertNode(int id, const std::string& name) : Node(id, name) {}
+
+std::shared_ptr<Node> ColorConvertNode::clone() const {
+    auto copy = std::make_shared<ColorConvertNode>(id, name);
+    copy->conversion = conversion;
+    return copy;
+}
+
+void ColorConvertNode::writeParameters(cv::FileStorage& fs) const {
+    fs << "conversion" << (int)conversion;
+}
+
+void ColorConvertNode::readParameters(const cv::FileNode& node) {
+    int index = (int)conversion;
+    cv::read(node["conversion"], index, index);
+    conversion = static_cast<Conversion>(std::clamp(index, 0, (int)Conversion::Grayscale));
+}
+
+void ColorConvertNode::setInputs(const std::vector<cv::Mat>& input) {
+    if (!input.empty()) {
+        inputImage = input[0];
+    } else {
+        inputImage.release();
+    }
+}
+
+// BGR <-> HSV / Lab / YCbCr through cv::cvtColor on interleaved 3-channel
+// data. Alpha passes through: the colour is unpremultiplied on the way in and
+// premultiplied again on the way back to BGR, so a round trip is lossless.
+void ColorConvertNode::convertSpace(const cv::Mat& input, cv::Mat& output) const {
+    cv::Mat image = toInterleaved(input);
+    int depth = image.depth();
+    bool toBgr = conversion == Conversion::HsvToBgr || conversion == Conversion::LabToBgr ||
+                 conversion == Conversion::YCbCrToBgr;
+
+    cv::Mat color, alpha;
+    if (image.channels() == 4) {
+        cv::Mat straight = image.clone();
+        if (!toBgr) {
+            dispatchPixelType(depth, 4, [&](auto pixel) {
+                unpremultiplyKernel<typename decltype(pixel)::Type>(straight);
+            });
+        }
+        cv::extractChannel(straight, alpha, 3);
+        cv::cvtColor(straight, color, cv::COLOR_BGRA2BGR);
+    } else {
+        color = image;
+    }
+
+    int code = 0;
+    const ChannelRanges* ranges = nullptr;
+    switch (conversion) {
+        case Conversion::BgrToHsv:   code = cv::COLOR_BGR2HSV_FULL; ranges = &kHsvRanges; break;
+        case Conversion::HsvToBgr:   code = cv::COLOR_HSV2BGR_FULL; ranges = &kHsvRanges; break;
+        case Conversion::BgrToLab:   code = cv::COLOR_BGR2Lab; ranges = &kLabRanges; break;
+        case Conversion::LabToBgr:   code = cv::COLOR_Lab2BGR; ranges = &kLabRanges; break;
+        case Conversion::BgrToYCbCr: code = cv::COLOR_BGR2YCrCb; break;
+        case Conversion::YCbCrToBgr: code = cv::COLOR_YCrCb2BGR; break;
+        default: break;
+    }
+
+    cv::Mat converted;
+    if (depth == CV_16U && ranges) {
+        // OpenCV has no 16-bit HSV / Lab: go through float
+        cv::Mat floats;
+        if (toBgr) {
+            rescale16(color, floats, *ranges, true);
+            cv::cvtColor(floats, floats, code);
+            floats.convertTo(converted, CV_16U, 65535.0);
+        } else {
+            color.convertTo(floats, CV_32F, 1.0 / 65535.0);
+            cv::cvtColor(floats, floats, code);
+            rescale16(floats, converted, *ranges, false);
+        }
+    } else {
+        cv::cvtColor(color, converted, code);
+    }
+
+    if (!alpha.empty()) {
+        cv::Mat channels[4];
+        cv::split(converted, channels);
+        channels[3] = alpha;
+        cv::merge(channels, 4, output);
+        if (toBgr) {
+            dispatchPixelType(depth, 4, [&](auto pixel) {
+                premultiplyKernel<typename decltype(pixel)::Type>(output);
+            });
+        }
+    } else {
+        output = converted;
+    }
+
+    if (isPlanar(input)) {
+        output = toPlanar(output);
+    }
+}
+
+bool ColorConvertNode::apply(const cv::Mat& input, cv::Mat& output) const {
+    if (input.empty()) {
+        output.release();
+        return true;
+    }
+
+    int channels = imageChannels(input);
+
+    if (conversion == Conversion::SrgbToLinear || conversion == Conversion::LinearToSrgb) {
+        Transfer transfer = conversion == Conversion::SrgbToLinear ? Transfer::SrgbToLinear : Transfer::LinearToSrgb;
+        bool handled = dispatchPixelType(input.depth(), channels, [&](auto pixel) {
+            using P = decltype(pixel);
+            transferKernel<typename P::Type, P::channels>(input, output, transfer);
+        });
+        if (!handled) output = input;
+        return handled;
+    }
+
+    if (conversion == Conversion::Grayscale) {
+        if (channels < 3) {
+            output = input;
+            return false;
+        }
+        // premultiplied BGRA: gray of the premultiplied colour is gray * alpha
+        cv::Mat gray;
+        cv::cvtColor(toInterleaved(input), gray, channels == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+        if (isPlanar(input)) {
+            // one plane: same memory, planar header
+            int sizes[3] = { 1, gray.rows, gray.cols };
+            output = gray.reshape(1, 3, sizes);
+        } else {
+            output = gray;
+        }
+        return true;
+    }
+
+    if (channels < 3) {
+        output = input; // no colour to convert
+        return false;
+    }
+    convertSpace(input, output);
+    return true;
+}
+
+void ColorConvertNode::process() {
+    if (outputIsInput) {
+        outputImage.release(); // still an earlier input; don't convert into it
+    }
+    outputIsInput = !apply(inputImage, outputImage);
+}
+
+void ColorConvertNode::compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>&) const {
+    releaseUnlessExclusive(outputs[0]);
+    apply(inputs[0], outputs[0]);
+}
+
+cv::Mat ColorConvertNode::getOutput(int) const {
+    return outputImage;
+}
+
+void ColorConvertNode::preview() {
+    if (outputImage.empty()) {
+        ImGui::Text("No output");
+        return;
+    }
+
+    if (textureID) glDeleteTextures(1, &textureID);
+    textureID = matToTexture(outputImage);
+
+    if (textureID && glIsTexture(textureID)) {
+        ImGui::Text("Preview:");
+        ImGui::Image((ImTextureID)(intptr_t)textureID, ImVec2(128, 128), ImVec2(1, 0), ImVec2(0, 1));
+    }
+}
+
+void ColorConvertNode::renderPropertiesUI() {
+    ImGui::Text("Color Conversion");
+
+    int index = (int)conversion;
+    if (ImGui::Combo("Conversion", &index, kConversionNames, IM_ARRAYSIZE(kConversionNames))) {
+        conversion = static_cast<Conversion>(index);
+        markDirty();
+    }
+
+    if (!inputImage.empty() && imageChannels(inputImage) < 3 &&
+        conversion != Conversion::SrgbToLinear && conversion != Conversion::LinearToSrgb) {
+        ImGui::TextDisabled("Single-channel input passes through");
+    }
+}
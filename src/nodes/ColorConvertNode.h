@@ -0,0 +1,48 @@
+#pragma once
+#include "../core/Node.h"
+#include <opencv2/opencv.hpp>
+#include <GL/gl.h>
+
+// Colour conversions: the sRGB transfer curve in either direction (so blurs
+// and blends can run on linear light), BGR to/from HSV, Lab and YCbCr, and
+// grayscale. Encodings follow OpenCV for 8-bit (HSV hue spans 0..255) and
+// float (hue in degrees, L in 0..100); 16-bit spans each channel's range.
+class ColorConvertNode : public Node {
+public:
+    enum class Conversion {
+        SrgbToLinear, LinearToSrgb,
+        BgrToHsv, HsvToBgr,
+        BgrToLab, LabToBgr,
+        BgrToYCbCr, YCbCrToBgr,
+        Grayscale
+    };
+
+private:
+    cv::Mat inputImage, outputImage;
+    bool outputIsInput = false; // the last process() passed its input through
+    GLuint textureID = 0;
+
+    Conversion conversion = Conversion::SrgbToLinear;
+
+    // False when output is just input, passed through.
+    bool apply(const cv::Mat& input, cv::Mat& output) const;
+    void convertSpace(const cv::Mat& input, cv::Mat& output) const;
+
+public:
+    ColorConvertNode(int id, const std::string& name = "Color Convert");
+
+    void setInputs(const std::vector<cv::Mat>& input) override;
+    void process() override;
+    void compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>& requested) const override;
+    std::shared_ptr<Node> clone() const override;
+    const char* typeName() const override { return "ColorConvert"; }
+    void writeParameters(cv::FileStorage& fs) const override;
+    void readParameters(const cv::FileNode& node) override;
+    cv::Mat getOutput(int port = 0) const override;
+    void preview() override;
+    void renderPropertiesUI() override;
+
+    ~ColorConvertNode() override {
+        if (textureID) glDeleteTextures(1, &textureID);
+    }
+};
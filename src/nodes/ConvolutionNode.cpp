@@ -0,0 +1,308 @@
+#include "ConvolutionNode.h"
+#include "../utils/TextureUtils.h"
+#include "imgui.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <tuple>
+
+static const char* kStrategyNames[] = { "Auto", "Separable", "Direct", "FFT" };
+
+ConvolutionNode::ConvolutionNode(int id, const std::string& name) : Node(id, name) {
+    rebuildKernel();
+}
+
+std::shared_ptr<Node> ConvolutionNode::clone() const {
+    auto copy = std::make_shared<ConvolutionNode>(id, name);
+    copy->kernelText = kernelText;
+    copy->normalize = normalize;
+    copy->forced = forced;
+    copy->rebuildKernel();
+    return copy;
+}
+
+void ConvolutionNode::writeParameters(cv::FileStorage& fs) const {
+    fs << "kernel" << kernelText << "normalize" << (int)normalize << "strategy" << (int)forced;
+}
+
+void ConvolutionNode::readParameters(const cv::FileNode& node) {
+    int strategy = (int)forced;
+    cv::read(node["kernel"], kernelText, kernelText);
+    cv::read(node["normalize"], normalize, normalize);
+    cv::read(node["strategy"], strategy, strategy);
+    forced = static_cast<Strategy>(std::clamp(strategy, 0, 3));
+    rebuildKernel();
+}
+
+cv::Mat ConvolutionNode::parseKernel(const std::string& text) {
+    std::vector<std::vector<float>> rows(1);
+    std::string token;
+    auto flush = [&] {
+        if (!token.empty()) {
+            try {
+                rows.back().push_back(std::stof(token));
+            } catch (const std::exception&) {
+                rows.clear(); // poison: not a number
+            }
+            token.clear();
+        }
+    };
+
+    for (char ch : text + ";") {
+        if (ch == ';' || ch == '\n') {
+            flush();
+            if (rows.empty()) return cv::Mat();
+            if (!rows.back().empty()) rows.emplace_back();
+        } else if (ch == ' ' || ch == ',' || ch == '\t') {
+            flush();
+            if (rows.empty()) return cv::Mat();
+        } else {
+            token += ch;
+        }
+    }
+    rows.pop_back(); // always empty after the trailing ';'
+
+    if (rows.empty()) return cv::Mat();
+    cv::Mat kernel((int)rows.size(), (int)rows[0].size(), CV_32F);
+    for (int y = 0; y < kernel.rows; ++y) {
+        if (rows[y].size() != rows[0].size()) return cv::Mat();
+        std::copy(rows[y].begin(), rows[y].end(), kernel.ptr<float>(y));
+    }
+    return kernel;
+}
+
+void ConvolutionNode::rebuildKernel() {
+    kernel = parseKernel(kernelText);
+    separable = false;
+    if (kernel.empty()) return;
+
+    double sum = cv::sum(kernel)[0];
+    if (normalize && std::abs(sum) > 1e-12) {
+        kernel /= sum;
+    }
+
+    // rank-1 test: K = s0 u v^T when the second singular value vanishes
+    cv::Mat w, u, vt;
+    cv::SVD::compute(kernel, w, u, vt);
+    float s0 = w.at<float>(0);
+    float s1 = w.rows > 1 ? w.at<float>(1) : 0.0f;
+    if (s0 > 0 && s1 <= s0 * 1e-5f) {
+        float scale = std::sqrt(s0);
+        kernelY = u.col(0) * scale;              // column pass, rows x 1
+        kernelX = (vt.row(0) * scale).t();       // row pass, cols x 1
+        separable = true;
+    }
+}
+
+// Circular convolution via the DFT, arranged so the result matches filter2D
+// (correlation with the kernel, reflected borders) on one single-channel plane.
+static void convolveFFT(const cv::Mat& src, const cv::Mat& kernel, const cv::Mat& kernelSpectrum,
+                        cv::Size dftSize, cv::Mat& dst) {
+    int ax = kernel.cols / 2, ay = kernel.rows / 2;
+
+    cv::Mat padded = cv::Mat::zeros(dftSize, CV_32F);
+    cv::Mat region = padded(cv::Rect(0, 0, src.cols + kernel.cols - 1, src.rows + kernel.rows - 1));
+    cv::Mat srcFloat;
+    src.convertTo(srcFloat, CV_32F);
+    cv::copyMakeBorder(srcFloat, region, ay, kernel.rows - 1 - ay, ax, kernel.cols - 1 - ax, cv::BORDER_REFLECT_101);
+
+    cv::dft(padded, padded, 0, region.rows);
+    cv::mulSpectrums(padded, kernelSpectrum, padded, 0);
+    cv::dft(padded, padded, cv::DFT_INVERSE | cv::DFT_SCALE, region.rows);
+
+    // full convolution of the padded plane with the flipped kernel: the
+    // correlation result starts at (kernel.cols - 1, kernel.rows - 1)
+    padded(cv::Rect(kernel.cols - 1, kernel.rows - 1, src.cols, src.rows)).convertTo(dst, src.depth());
+}
+
+void ConvolutionNode::run(Strategy strategy, const cv::Mat& input, cv::Mat& output) const {
+    std::vector<cv::Mat> inPlanes, outPlanes;
+    bool planar = isPlanar(input);
+
+    if (strategy == Strategy::FFT) {
+        // one kernel spectrum shared by every plane
+        cv::Size size = imageSize(input);
+        cv::Size dftSize(cv::getOptimalDFTSize(size.width + kernel.cols - 1),
+                         cv::getOptimalDFTSize(size.height + kernel.rows - 1));
+        cv::Mat spectrum = cv::Mat::zeros(dftSize, CV_32F);
+        cv::Mat flipped;
+        cv::flip(kernel, flipped, -1);
+        flipped.copyTo(spectrum(cv::Rect(0, 0, kernel.cols, kernel.rows)));
+        cv::dft(spectrum, spectrum, 0, kernel.rows);
+
+        if (planar) {
+            createPlanar(output, size, imageChannels(input), input.depth());
+            inPlanes = planeViews(input);
+            outPlanes = planeViews(output);
+        } else {
+            cv::split(input, inPlanes);
+            outPlanes.resize(inPlanes.size());
+        }
+        for (size_t c = 0; c < inPlanes.size(); ++c) {
+            cv::Mat plane;
+            convolveFFT(inPlanes[c], kernel, spectrum, dftSize, plane);
+            if (planar) plane.copyTo(outPlanes[c]);
+            else outPlanes[c] = plane;
+        }
+        if (!planar) cv::merge(outPlanes, output);
+        return;
+    }
+
+    auto filter = [&](const cv::Mat& src, cv::Mat& dst) {
+        if (strategy == Strategy::Separable) {
+            cv::sepFilter2D(src, dst, -1, kernelX, kernelY);
+        } else {
+            cv::filter2D(src, dst, -1, kernel);
+        }
+    };
+
+    if (planar) {
+        createPlanar(output, imageSize(input), imageChannels(input), input.depth());
+        for (int c = 0; c < imageChannels(input); ++c) {
+            cv::Mat dst = planeView(output, c);
+            filter(planeView(input, c), dst);
+        }
+    } else {
+        filter(input, output);
+    }
+}
+
+// Measured choice, cached process-wide per kernel shape and image type: the
+// kernel's values don't change the cost, its size and separability do.
+ConvolutionNode::Strategy ConvolutionNode::chooseStrategy(const cv::Mat& input) const {
+    if (forced != Strategy::Auto) {
+        return forced == Strategy::Separable && !separable ? Strategy::Direct : forced;
+    }
+
+    using Key = std::tuple<int, int, bool, int, int, bool>;
+    static std::mutex mutex;
+    static std::map<Key, Strategy> cache;
+
+    Key key { kernel.rows, kernel.cols, separable, input.depth(), imageChannels(input), isPlanar(input) };
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = cache.find(key);
+        if (it != cache.end()) return it->second;
+    }
+
+    // time each candidate on a tile of the real input (per-pixel cost carries
+    // over to the full frame well enough to rank them)
+    cv::Size size = imageSize(input);
+    int tileSize = std::max(256, std::max(kernel.rows, kernel.cols) * 4);
+    cv::Rect tile((size.width - std::min(size.width, tileSize)) / 2, (size.height - std::min(size.height, tileSize)) / 2,
+                  std::min(size.width, tileSize), std::min(size.height, tileSize));
+    cv::Mat sample = isPlanar(input) ? toPlanar(toInterleaved(input)(tile).clone()) : input(tile).clone();
+
+    Strategy best = Strategy::Direct;
+    double bestSeconds = 1e30;
+    for (Strategy candidate : { Strategy::Separable, Strategy::Direct, Strategy::FFT }) {
+        if (candidate == Strategy::Separable && !separable) continue;
+        cv::Mat out;
+        run(candidate, sample, out); // warm-up: allocations, FFT plans
+        auto start = std::chrono::steady_clock::now();
+        run(candidate, sample, out);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (seconds < bestSeconds) {
+            bestSeconds = seconds;
+            best = candidate;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    cache[key] = best;
+    return best;
+}
+
+bool ConvolutionNode::apply(const cv::Mat& input, cv::Mat& output) const {
+    if (input.empty() || kernel.empty()) {
+        output = input; // unparseable kernel: pass through
+        return false;
+    }
+    Strategy strategy = chooseStrategy(input);
+    lastStrategy = (int)strategy;
+    run(strategy, input, output);
+    return true;
+}
+
+void ConvolutionNode::setInputs(const std::vector<cv::Mat>& input) {
+    if (!input.empty()) {
+        inputImage = input[0];
+    } else {
+        inputImage.release();
+    }
+}
+
+void ConvolutionNode::process() {
+    if (outputIsInput) {
+        outputImage.release(); // still an earlier input; don't filter into it
+    }
+    outputIsInput = !apply(inputImage, outputImage);
+    textureDirty = true;
+}
+
+void ConvolutionNode::compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>&) const {
+    releaseUnlessExclusive(outputs[0]);
+    apply(inputs[0], outputs[0]);
+}
+
+cv::Mat ConvolutionNode::getOutput(int) const {
+    return outputImage;
+}
+
+void ConvolutionNode::preview() {
+    if (outputImage.empty()) {
+        ImGui::Text("No output");
+        return;
+    }
+
+    if (textureDirty) {
+        if (textureID) glDeleteTextures(1, &textureID);
+        textureID = matToTexture(outputImage);
+        textureDirty = false;
+    }
+
+    if (textureID && glIsTexture(textureID)) {
+        ImGui::Text("Preview:");
+        ImGui::Image((ImTextureID)(intptr_t)textureID, ImVec2(128, 128), ImVec2(1, 0), ImVec2(0, 1));
+    }
+}
+
+void ConvolutionNode::renderPropertiesUI() {
+    ImGui::Text("Convolution");
+
+    bool updated = false;
+
+    char buffer[2048];
+    std::strncpy(buffer, kernelText.c_str(), sizeof(buffer));
+    buffer[sizeof(buffer) - 1] = '\0';
+    if (ImGui::InputTextMultiline("Kernel", buffer, sizeof(buffer), ImVec2(0, 100))) {
+        kernelText = buffer;
+        updated = true;
+    }
+    ImGui::TextDisabled("Rows separated by ';' or new lines");
+
+    updated |= ImGui::Checkbox("Normalize (divide by sum)", &normalize);
+
+    int strategy = (int)forced;
+    if (ImGui::Combo("Strategy", &strategy, kStrategyNames, IM_ARRAYSIZE(kStrategyNames))) {
+        forced = static_cast<Strategy>(strategy);
+        updated = true;
+    }
+
+    if (updated) {
+        rebuildKernel();
+        markDirty();
+    }
+
+    if (kernel.empty()) {
+        ImGui::TextColored(ImVec4(1, 0.3f, 0.3f, 1), "Kernel does not parse (rows must be equally long)");
+        return;
+    }
+    ImGui::Text("Kernel: %d x %d%s", kernel.cols, kernel.rows, separable ? " (separable)" : "");
+    if (!inputImage.empty()) {
+        ImGui::Text("Using: %s", kStrategyNames[lastStrategy.load()]);
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include "../core/Node.h"
+#include <GL/gl.h>
+#include <atomic>
+#include <string>
+
+// Convolves with a user kernel (OpenCV filter2D semantics: correlation,
+// centred anchor, reflected borders). How is decided per kernel shape and
+// image type by timing the candidates once on a tile of the real input:
+//   - Separable: rank-1 kernels (found by SVD) as a row and a column pass
+//   - Direct: spatial filtering, best for small kernels
+//   - FFT: frequency-domain product, best for large ones
+// The kernel is applied as typed at every resolution: unlike radii, a proxy
+// preview does not shrink it, so it looks wider there than in the render.
+class ConvolutionNode : public Node {
+public:
+    enum class Strategy { Auto, Separable, Direct, FFT };
+
+private:
+    cv::Mat inputImage, outputImage;
+    bool outputIsInput = false; // the last process() passed its input through
+    GLuint textureID = 0;
+    bool textureDirty = false;
+
+    std::string kernelText = "1 4 6 4 1; 4 16 24 16 4; 6 24 36 24 6; 4 16 24 16 4; 1 4 6 4 1";
+    bool normalize = true;
+    Strategy forced = Strategy::Auto;
+
+    // derived from kernelText by rebuildKernel()
+    cv::Mat kernel;            // CV_32F, empty if the text does not parse
+    cv::Mat kernelX, kernelY;  // rank-1 factors when separable
+    bool separable = false;
+    mutable std::atomic<int> lastStrategy{(int)Strategy::Auto};
+
+    void rebuildKernel();
+    Strategy chooseStrategy(const cv::Mat& input) const;
+    // False when output is just input, passed through.
+    bool apply(const cv::Mat& input, cv::Mat& output) const;
+    void run(Strategy strategy, const cv::Mat& input, cv::Mat& output) const;
+
+public:
+    ConvolutionNode(int id, const std::string& name = "Convolution");
+
+    void setInputs(const std::vector<cv::Mat>& input) override;
+    void process() override;
+    void compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>& requested) const override;
+    std::shared_ptr<Node> clone() const override;
+    const char* typeName() const override { return "Convolution"; }
+    void writeParameters(cv::FileStorage& fs) const override;
+    void readParameters(const cv::FileNode& node) override;
+    cv::Mat getOutput(int port = 0) const override;
+    void preview() override;
+    void renderPropertiesUI() override;
+    int haloRows() const override { return kernel.rows / 2; }
+
+    // Parses "a b c; d e f; ..." (rows split by ';' or newlines, values by
+    // spaces or commas). Returns an empty Mat unless all rows are equally long.
+    static cv::Mat parseKernel(const std::string& text);
+
+    ~ConvolutionNode() override {
+        if (textureID) glDeleteTextures(1, &textureID);
+    }
+};
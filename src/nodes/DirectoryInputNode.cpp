@@ -0,0 +1,110 @@
+#include "DirectoryInputNode.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <regex>
+#include "imgui.h"
+
+namespace fs = std::filesystem;
+
+static bool isImagePath(const fs::path& path) {
+    static const char* extensions[] = { ".jpg", ".jpeg", ".png", ".bmp", ".tif", ".tiff", ".exr", ".webp", ".nbraw" };
+    std::string extension = path.extension().string();
+    for (auto& ch : extension) ch = (char)std::tolower((unsigned char)ch);
+    return std::find(std::begin(extensions), std::end(extensions), extension) != std::end(extensions);
+}
+
+DirectoryInputNode::DirectoryInputNode(int id, const std::string& pattern, const std::string& name)
+    : InputNode(id, "", name), pattern(pattern) {}
+
+std::shared_ptr<Node> DirectoryInputNode::clone() const {
+    // workers are handed files directly, they never need the listing
+    auto copy = std::make_shared<DirectoryInputNode>(id, pattern, name);
+    copy->setFilepath(getFilepath());
+    copy->watchForChanges = false;
+    return copy;
+}
+
+void DirectoryInputNode::writeParameters(cv::FileStorage& fs) const {
+    fs << "pattern" << pattern;
+}
+
+void DirectoryInputNode::readParameters(const cv::FileNode& node) {
+    cv::read(node["pattern"], pattern, pattern);
+    scan();
+}
+
+std::vector<std::string> DirectoryInputNode::listFiles(const std::string& pattern) {
+    std::vector<std::string> matches;
+    if (pattern.empty()) return matches;
+
+    std::error_code ec;
+    fs::path dir = pattern;
+    std::regex match(".*");
+    bool isGlob = pattern.find_first_of("*?") != std::string::npos;
+
+    if (isGlob) {
+        fs::path globPath(pattern);
+        dir = globPath.has_parent_path() ? globPath.parent_path() : fs::path(".");
+
+        // translate the file name glob into a regex, escaping everything else
+        std::string expression;
+        for (char ch : globPath.filename().string()) {
+            if (ch == '*') expression += ".*";
+            else if (ch == '?') expression += '.';
+            else if (std::strchr(".^$|()[]{}+\\", ch)) expression += std::string("\\") + ch;
+            else expression += ch;
+        }
+        match = std::regex(expression);
+    } else if (!fs::is_directory(dir, ec)) {
+        return matches;
+    }
+
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        if (!entry.is_regular_file(ec)) continue;
+        // a glob like "shots/*" would otherwise count every sidecar as a failed render
+        if (!isImagePath(entry.path())) continue;
+        if (isGlob && !std::regex_match(entry.path().filename().string(), match)) continue;
+        matches.push_back(entry.path().string());
+    }
+    std::sort(matches.begin(), matches.end());
+    return matches;
+}
+
+void DirectoryInputNode::scan() {
+    files = listFiles(pattern);
+    previewIndex = 0;
+    setFilepath(files.empty() ? "" : files.front());
+}
+
+void DirectoryInputNode::renderPropertiesUI() {
+    ImGui::Text("Directory Input");
+
+    char buf[512];
+    std::strncpy(buf, pattern.c_str(), sizeof(buf));
+    buf[sizeof(buf) - 1] = '\0';
+    if (ImGui::InputText("Pattern", buf, sizeof(buf))) {
+        pattern = buf;
+    }
+    ImGui::TextDisabled("a directory, or a glob like plates/*.png");
+
+    if (ImGui::Button("Scan")) {
+        scan();
+    }
+
+    if (files.empty()) {
+        ImGui::Text("No matching files.");
+        return;
+    }
+
+    ImGui::Text("Files: %zu", files.size());
+    if (ImGui::SliderInt("Preview File", &previewIndex, 0, (int)files.size() - 1)) {
+        setFilepath(files[previewIndex]);
+    }
+    ImGui::TextDisabled("%s", getFilepath().c_str());
+
+    if (isLoading()) {
+        ImGui::Text("Loading...");
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include "InputNode.h"
+#include <string>
+#include <vector>
+
+// Input node over many files: a directory (every image in it) or a glob on
+// the file name ("plates/*_v2.png"). Interactively it previews one match like
+// a regular Input node; BatchRenderer evaluates the graph once per match.
+class DirectoryInputNode : public InputNode {
+private:
+    std::string pattern;
+    std::vector<std::string> files;
+    int previewIndex = 0;
+
+public:
+    DirectoryInputNode(int id, const std::string& pattern = "", const std::string& name = "Directory Input");
+
+    std::shared_ptr<Node> clone() const override;
+    const char* typeName() const override { return "DirectoryInput"; }
+    void writeParameters(cv::FileStorage& fs) const override;
+    void readParameters(const cv::FileNode& node) override;
+    void renderPropertiesUI() override;
+
+    // Re-lists the files matching the pattern and previews the first one.
+    void scan();
+    const std::string& getPattern() const { return pattern; }
+    const std::vector<std::string>& getFiles() const { return files; }
+
+    // Sorted paths matching a directory or a '*' / '?' file name glob.
+    static std::vector<std::string> listFiles(const std::string& pattern);
+};
@@ -0,0 +1,154 @@
+#include "EdgeNode.h"
+#include "../utils/TextureUtils.h"
+#include "../utils/EdgeKernels.h"
+#include "imgui.h"
+#include <algorithm>
+
+static const char* kModeNames[] = { "Sobel", "Scharr", "Canny" };
+
+EdgeNode::EdgeNode(int id, const std::string& name) : Node(id, name) {}
+
+std::shared_ptr<Node> EdgeNode::clone() const {
+    auto copy = std::make_shared<EdgeNode>(id, name);
+    copy->mode = mode;
+    copy->binary = binary;
+    copy->threshold = threshold;
+    copy->lowThreshold = lowThreshold;
+    copy->highThreshold = highThreshold;
+    copy->l2Gradient = l2Gradient;
+    return copy;
+}
+
+void EdgeNode::writeParameters(cv::FileStorage& fs) const {
+    fs << "mode" << (int)mode << "binary" << (int)binary << "threshold" << threshold
+       << "lowThreshold" << lowThreshold << "highThreshold" << highThreshold << "l2Gradient" << (int)l2Gradient;
+}
+
+void EdgeNode::readParameters(const cv::FileNode& node) {
+    int modeIndex = (int)mode;
+    cv::read(node["mode"], modeIndex, modeIndex);
+    mode = static_cast<Mode>(std::clamp(modeIndex, 0, 2));
+    cv::read(node["binary"], binary, binary);
+    cv::read(node["threshold"], threshold, threshold);
+    cv::read(node["lowThreshold"], lowThreshold, lowThreshold);
+    cv::read(node["highThreshold"], highThreshold, highThreshold);
+    cv::read(node["l2Gradient"], l2Gradient, l2Gradient);
+}
+
+void EdgeNode::setInputs(const std::vector<cv::Mat>& input) {
+    if (!input.empty()) {
+        inputImage = input[0];
+    } else {
+        inputImage.release();
+    }
+}
+
+void EdgeNode::apply(const cv::Mat& input, cv::Mat& output) const {
+    if (input.empty()) {
+        output.release();
+        return;
+    }
+
+    if (mode != Mode::Canny) {
+        EdgeOperator op = mode == Mode::Sobel ? EdgeOperator::Sobel : EdgeOperator::Scharr;
+        bool handled = dispatchPixelType(input.depth(), imageChannels(input), [&](auto pixel) {
+            using P = decltype(pixel);
+            edgeMagnitudeKernel<typename P::Type, P::channels>(input, output, op, binary ? threshold : -1.0f);
+        });
+        if (handled) return;
+    } else {
+        cv::Mat dx, dy;
+        bool handled = dispatchPixelType(input.depth(), imageChannels(input), [&](auto pixel) {
+            using P = decltype(pixel);
+            edgeDerivativesKernel<typename P::Type, P::channels>(input, dx, dy, EdgeOperator::Sobel);
+        });
+        if (handled) {
+            cv::Mat edges;
+            cv::Canny(dx, dy, edges, lowThreshold, highThreshold, l2Gradient);
+            cv::Mat out = createSingleChannel(input, output);
+            edges.convertTo(out, input.depth(), input.depth() == CV_32F ? 1.0 / 255.0 : (input.depth() == CV_16U ? 257.0 : 1.0));
+            return;
+        }
+    }
+
+    // unsupported depth or channel count: go through OpenCV on 8-bit gray
+    cv::Mat gray, edges;
+    cv::Mat interleaved = toInterleaved(input);
+    interleaved.convertTo(gray, CV_8U, input.depth() == CV_32F ? 255.0 : (input.depth() == CV_16U ? 1.0 / 257.0 : 1.0));
+    if (gray.channels() > 1) cv::cvtColor(gray, gray, gray.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+    if (mode == Mode::Canny) {
+        cv::Canny(gray, edges, lowThreshold, highThreshold, 3, l2Gradient);
+    } else {
+        cv::Mat gx, gy;
+        int ksize = mode == Mode::Sobel ? 3 : cv::FILTER_SCHARR;
+        cv::Sobel(gray, gx, CV_32F, 1, 0, ksize);
+        cv::Sobel(gray, gy, CV_32F, 0, 1, ksize);
+        cv::magnitude(gx, gy, edges);
+        edges.convertTo(edges, CV_8U, mode == Mode::Sobel ? 0.25 : 1.0 / 16.0);
+        if (binary) cv::threshold(edges, edges, threshold * 255.0, 255, cv::THRESH_BINARY);
+    }
+    output = edges;
+}
+
+void EdgeNode::process() {
+    apply(inputImage, outputImage);
+}
+
+void EdgeNode::compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>&) const {
+    apply(inputs[0], outputs[0]);
+}
+
+cv::Mat EdgeNode::getOutput(int) const {
+    return outputImage;
+}
+
+void EdgeNode::preview() {
+    if (outputImage.empty()) {
+        ImGui::Text("No output");
+        return;
+    }
+
+    if (textureID) glDeleteTextures(1, &textureID);
+    textureID = matToTexture(outputImage);
+
+    if (textureID && glIsTexture(textureID)) {
+        ImGui::Text("Preview:");
+        ImGui::Image((ImTextureID)(intptr_t)textureID, ImVec2(128, 128), ImVec2(1, 0), ImVec2(0, 1));
+    }
+}
+
+void EdgeNode::renderPropertiesUI() {
+    ImGui::Text("Edge Detection");
+
+    bool updated = false;
+
+    int modeIndex = (int)mode;
+    if (ImGui::Combo("Operator", &modeIndex, kModeNames, IM_ARRAYSIZE(kModeNames))) {
+        mode = static_cast<Mode>(modeIndex);
+        updated = true;
+    }
+
+    if (mode == Mode::Canny) {
+        updated |= ImGui::SliderFloat("Low Threshold", &lowThreshold, 0.0f, 500.0f);
+        updated |= ImGui::SliderFloat("High Threshold", &highThreshold, 0.0f, 500.0f);
+        updated |= ImGui::Checkbox("L2 Gradient", &l2Gradient);
+    } else {
+        updated |= ImGui::Checkbox("Binary", &binary);
+        if (binary) {
+            updated |= ImGui::SliderFloat("Threshold", &threshold, 0.0f, 1.0f);
+        }
+    }
+
+    if (ImGui::Button("Reset")) {
+        binary = false;
+        threshold = 0.2f;
+        lowThreshold = 50.0f;
+        highThreshold = 150.0f;
+        l2Gradient = true;
+        updated = true;
+    }
+
+    if (updated) {
+        markDirty();
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "../core/Node.h"
+#include <opencv2/opencv.hpp>
+#include <GL/gl.h>
+
+// Edge detection on the luminance of the input. Sobel and Scharr produce the
+// gradient magnitude (or a binary mask when thresholded) in one fused pass;
+// Canny feeds the same fused derivatives to OpenCV's non-maximum suppression
+// and hysteresis. The output has a single channel at the input's depth.
+class EdgeNode : public Node {
+public:
+    enum class Mode { Sobel, Scharr, Canny };
+
+private:
+    cv::Mat inputImage, outputImage;
+    GLuint textureID = 0;
+
+    Mode mode = Mode::Sobel;
+    bool binary = false;
+    float threshold = 0.2f;      // Sobel/Scharr, fraction of a full step edge
+    float lowThreshold = 50.0f;  // Canny, on the 0..255 gradient scale
+    float highThreshold = 150.0f;
+    bool l2Gradient = true;
+
+    void apply(const cv::Mat& input, cv::Mat& output) const;
+
+public:
+    EdgeNode(int id, const std::string& name = "Edge Detect");
+
+    void setInputs(const std::vector<cv::Mat>& input) override;
+    void process() override;
+    void compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>& requested) const override;
+    std::shared_ptr<Node> clone() const override;
+    const char* typeName() const override { return "Edge"; }
+    void writeParameters(cv::FileStorage& fs) const override;
+    void readParameters(const cv::FileNode& node) override;
+    cv::Mat getOutput(int port = 0) const override;
+    void preview() override;
+    void renderPropertiesUI() override;
+    int haloRows() const override { return mode == Mode::Canny ? 2 : 1; }
+    // Canny's hysteresis follows weak edges any distance, across strip seams
+    bool isStreamable() const override { return mode != Mode::Canny; }
+
+    ~EdgeNode() override {
+        if (textureID) glDeleteTextures(1, &textureID);
+    }
+};
@@ -1,30 +1,167 @@
 #include "InputNode.h"
 #include <opencv2/imgcodecs.hpp>
+#include <algorithm>
+#include <cctype>
+#include <fstream>
 #include <iostream>
 #include "../utils/TextureUtils.h"
+#include "../utils/SourceImage.h"
+#include "../utils/ThreadPool.h"
+#include "../utils/FileWatcher.h"
 #include "imgui.h"
 
+static bool isJpegPath(const std::string& path) {
+    auto dot = path.rfind('.');
+    if (dot == std::string::npos) return false;
+    std::string extension = path.substr(dot);
+    for (auto& ch : extension) ch = (char)std::tolower((unsigned char)ch);
+    return extension == ".jpg" || extension == ".jpeg";
+}
+
+// Whether an IMREAD_UNCHANGED decode could come back with an alpha channel.
+// JPEG never has one; a PNG says so in its IHDR colour type (palette images
+// may carry a tRNS chunk, so they count). Anything else is assumed to.
+static bool mayHaveAlpha(const std::string& path) {
+    if (isJpegPath(path)) return false;
+
+    std::ifstream file(path, std::ios::binary);
+    unsigned char header[26] = {};
+    if (!file.read(reinterpret_cast<char*>(header), sizeof(header))) return true;
+    static const unsigned char pngSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    if (std::equal(pngSignature, pngSignature + 8, header)) {
+        unsigned char colourType = header[25];
+        return colourType == 3 || colourType == 4 || colourType == 6;
+    }
+    return true;
+}
+
 InputNode::InputNode(int id, const std::string& defaultPath, const std::string& name) : Node(id, name), filepath(defaultPath) {}
 
-void InputNode::process() {
+std::shared_ptr<Node> InputNode::clone() const {
+    auto copy = std::make_shared<InputNode>(id, filepath, name);
+    copy->watchForChanges = false;
+    return copy;
+}
+
+void InputNode::writeParameters(cv::FileStorage& fs) const {
+    fs << "filepath" << filepath;
+}
+
+void InputNode::readParameters(const cv::FileNode& node) {
+    cv::read(node["filepath"], filepath, filepath);
+}
+
+InputNode::~InputNode() {
+    if (watchId) FileWatcher::shared().unwatch(watchId);
+    if (textureID) glDeleteTextures(1, &textureID);
+}
+
+void InputNode::setStreamedImage(const cv::Mat& strip) {
+    streaming = true;
+    image = strip;
+    textureDirty = true;
+    ++version;
+}
+
+void InputNode::endStreaming() {
+    streaming = false;
+    image.release();
+    ++version;
+    loadedPath.clear(); // reload the file on the next process()
+}
+
+void InputNode::watchFile() {
+    if (!watchForChanges || filepath == watchedPath) return;
+
+    if (watchId) FileWatcher::shared().unwatch(watchId);
+    watchedPath = filepath;
+    fileChanged->store(false);
+    // the flag outlives this node if a callback races with unwatch()
+    watchId = filepath.empty() ? 0 :
+        FileWatcher::shared().watch(filepath, [changed = fileChanged] { changed->store(true); });
+}
+
+cv::Mat InputNode::decodeFile(const std::string& filepath, WorkingFormat format, bool planar, int proxyScale) {
+    if (isRawImagePath(filepath)) {
+        return loadRawSourceImage(filepath, format, planar, proxyScale);
+    }
+
+    // JPEGs come out EXIF-oriented on both paths: the reduced decode applies
+    // the orientation, and JPEGs never take the UNCHANGED path below
+    if (proxyScale > 1 && isJpegPath(filepath)) {
+        // libjpeg scales in the DCT domain: a 1/8 load skips most of the decode,
+        // and its rounded-up size is the proxySize() every other path resizes to
+        int flags = proxyScale >= 8 ? cv::IMREAD_REDUCED_COLOR_8 :
+                    proxyScale >= 4 ? cv::IMREAD_REDUCED_COLOR_4 : cv::IMREAD_REDUCED_COLOR_2;
+        return prepareSourceImage(cv::imread(filepath, flags), format, planar);
+    }
+
+    // ANYDEPTH|ANYCOLOR keeps 16-bit PNG/TIFF and float EXR data intact and
+    // applies the EXIF orientation; only UNCHANGED keeps alpha, but it also
+    // skips the orientation, so it is used just for files that may have alpha
+    int flags = mayHaveAlpha(filepath) ? cv::IMREAD_UNCHANGED : cv::IMREAD_ANYDEPTH | cv::IMREAD_ANYCOLOR;
+    // no reduced decode for this codec: the proxy is shrunk from full size
+    return prepareSourceImage(cv::imread(filepath, flags), format, planar, proxyScale);
+}
+
+void InputNode::load() {
+    loadedPath = filepath;
+    loadedFormat = workingFormat;
+    loadedPlanar = planarLayout;
+    loadedProxy = proxyScale;
+    loadFailed = false;
+    watchFile();
     if (filepath.empty()) return;
 
-    image = cv::imread(filepath);
-    if (image.empty()) {
-        std::cerr << "Failed to load image: " << filepath << std::endl;
-        return;
+    // a previous load still in flight is simply superseded
+    pendingLoad = ThreadPool::io().submit(
+        [path = filepath, format = workingFormat, planar = planarLayout, proxy = proxyScale] {
+            return decodeFile(path, format, planar, proxy);
+        });
+}
+
+bool InputNode::isLoading() const {
+    return pendingLoad.valid();
+}
+
+void InputNode::waitForPendingWork() {
+    if (!streaming && pendingLoad.valid()) pendingLoad.wait();
+}
+
+void InputNode::process() {
+    if (streaming) return;
+
+    if (filepath != loadedPath || workingFormat != loadedFormat ||
+        planarLayout != loadedPlanar || proxyScale != loadedProxy ||
+        fileChanged->exchange(false)) {
+        load();
     }
 
-    if (textureID) glDeleteTextures(1, &textureID);
-    textureID = matToTexture(image);
+    // pick up a finished decode; downstream nodes see it in this same evaluation
+    if (pendingLoad.valid() &&
+        pendingLoad.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        image = pendingLoad.get();
+        loadFailed = image.empty();
+        if (loadFailed) {
+            std::cerr << "Failed to load image: " << loadedPath << std::endl;
+        }
+        textureDirty = true;
+        ++version; // downstream nodes re-evaluate; unrelated branches are left alone
+    }
 }
 
 void InputNode::preview() {
     if (image.empty()) {
-        ImGui::Text("No preview");
+        ImGui::Text(isLoading() ? "Loading..." : "No preview");
         return;
     }
 
+    if (textureDirty) {
+        if (textureID) glDeleteTextures(1, &textureID);
+        textureID = matToTexture(image);
+        textureDirty = false;
+    }
+
     if (textureID && glIsTexture(textureID)) {
         ImGui::Text("Preview:");
         ImGui::Image(
@@ -48,14 +185,25 @@ void InputNode::renderPropertiesUI() {
 
     if (ImGui::Button("Load")) {
         filepath = pendingPath;
-        process();
+        load();
+    }
+
+    if (isLoading()) {
+        ImGui::Text("Loading %s...", loadedPath.c_str());
+    } else if (loadFailed) {
+        ImGui::TextColored(ImVec4(1, 0.3f, 0.3f, 1), "Failed to load %s", loadedPath.c_str());
     }
 
     if (!image.empty()) {
         ImGui::Separator();
         ImGui::Text("Metadata:");
-        ImGui::Text("Dimensions: %d x %d", image.cols, image.rows);
-        ImGui::Text("Channels: %d", image.channels());
+        ImGui::Text("Dimensions: %d x %d", imageSize(image).width, imageSize(image).height);
+        if (proxyScale > 1 && !streaming) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(proxy 1/%d)", proxyScale);
+        }
+        ImGui::Text("Channels: %d", imageChannels(image));
+        ImGui::Text("Working format: %s", formatName(workingFormat));
 
         try {
             auto fsize = std::filesystem::file_size(filepath);
@@ -69,6 +217,11 @@ void InputNode::renderPropertiesUI() {
 }
 
 
-cv::Mat InputNode::getOutput() const {
+void InputNode::compute(const std::vector<cv::Mat>&, std::vector<cv::Mat>& outputs, const std::vector<bool>&) const {
+    // the loaded image is shared read-only by every context
+    outputs[0] = image;
+}
+
+cv::Mat InputNode::getOutput(int) const {
     return image;
 }
\ No newline at end of file
@@ -1,7 +1,10 @@
 #pragma once
 #include <opencv2/opencv.hpp>
 #include "../core/Node.h"
+#include <atomic>
 #include <filesystem>
+#include <future>
+#include <memory>
 #include <GL/gl.h>
 
 class InputNode : public Node {
@@ -9,17 +12,60 @@ private:
     cv::Mat image;
     std::string filepath;
     GLuint textureID = 0;
+    bool textureDirty = false; // uploads happen in preview() so evaluation stays GL-free
+    bool streaming = false;    // image is fed externally instead of read from filepath
+
+    // decoding happens on the I/O pool; these record what the last load asked for
+    std::future<cv::Mat> pendingLoad;
+    std::string loadedPath;
+    WorkingFormat loadedFormat = WorkingFormat::U8;
+    bool loadedPlanar = false;
+    int loadedProxy = 1;
+    bool loadFailed = false;
+
+    // hot reload: the watcher thread only raises the flag, process() re-decodes
+    int watchId = 0;
+    std::string watchedPath;
+    std::shared_ptr<std::atomic<bool>> fileChanged = std::make_shared<std::atomic<bool>>(false);
+
+    void load();
+    void watchFile();
+
+protected:
+    // Off in clones: worker graphs read their files once and must not pile
+    // inotify watches onto the editor's.
+    bool watchForChanges = true;
 
 public:
     InputNode(int id, const std::string& defaultPath = "", const std::string& name = "Input");
 
     void process() override;
-    cv::Mat getOutput() const override;
+    void compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>& requested) const override;
+    std::shared_ptr<Node> clone() const override;
+    const char* typeName() const override { return "Input"; }
+    void writeParameters(cv::FileStorage& fs) const override;
+    void readParameters(const cv::FileNode& node) override;
+    cv::Mat getOutput(int port = 0) const override;
+    int inputCount() const override { return 0; }
+    const char* outputName(int) const override { return "Output"; }
     void renderPropertiesUI() override;
     GLuint getTextureID() const { return textureID; }
+    const std::string& getFilepath() const { return filepath; }
+    // Takes effect (asynchronously) on the next process().
+    void setFilepath(const std::string& path) { filepath = path; }
+
+    // Reads a file and converts it to the graph's conventions (depth, layout,
+    // premultiplied alpha). Synchronous; safe to call from any thread.
+    static cv::Mat decodeFile(const std::string& path, WorkingFormat format, bool planar, int proxyScale = 1);
+
+    // Feed an already-prepared image (e.g. one strip of a huge TIFF) instead of
+    // reading filepath on process(). endStreaming() returns to file loading.
+    void setStreamedImage(const cv::Mat& strip);
+    void endStreaming();
+
+    bool isLoading() const;
+    void waitForPendingWork() override;
     void preview() override;
 
-    ~InputNode() override {
-        if (textureID) glDeleteTextures(1, &textureID);
-    }
+    ~InputNode() override;
 };
\ No newline at end of file
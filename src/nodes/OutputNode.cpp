@@ -2,30 +2,53 @@
 #include <opencv2/imgcodecs.hpp>
 #include <iostream>
 #include "../utils/TextureUtils.h"
+#include "../utils/EncoderPool.h"
 #include "imgui.h"
+#include <filesystem>
 #include <vector>
 
 OutputNode::OutputNode(int id, const std::string& name) : Node(id, name) {}
 
+std::shared_ptr<Node> OutputNode::clone() const {
+    auto copy = std::make_shared<OutputNode>(id, name);
+    copy->filename = filename;
+    copy->format = format;
+    copy->jpgQuality = jpgQuality;
+    copy->batchPattern = batchPattern;
+    return copy;
+}
+
+void OutputNode::writeParameters(cv::FileStorage& fs) const {
+    fs << "filename" << filename << "format" << format << "jpgQuality" << jpgQuality
+       << "batchPattern" << batchPattern;
+}
+
+void OutputNode::readParameters(const cv::FileNode& node) {
+    cv::read(node["filename"], filename, filename);
+    cv::read(node["format"], format, format);
+    cv::read(node["jpgQuality"], jpgQuality, jpgQuality);
+    cv::read(node["batchPattern"], batchPattern, batchPattern);
+}
+
 void OutputNode::process() {
     if (image.empty()) {
         // std::cerr << "OutputNode: no input image\n";
         return;
     }
-    
-    if (textureID) glDeleteTextures(1, &textureID); // cleanup old
-    textureID = matToTexture(image);
+}
+
+void OutputNode::compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>&) const {
+    outputs[0] = isPlanar(inputs[0]) ? toInterleaved(inputs[0]) : inputs[0];
 }
 
 void OutputNode::setInputs(const std::vector<cv::Mat>& input) {
     if (!input.empty()) {
-        image = input[0].clone();
+        // leave the graph's planar layout here; everything after is interleaved
+        image = isPlanar(input[0]) ? toInterleaved(input[0]) : input[0].clone();
     } else {
         image.release();
     }
-
-    if (textureID) glDeleteTextures(1, &textureID); // cleanup old
-    textureID = matToTexture(image);
+    textureDirty = true;
 }
 
 void OutputNode::preview() {
@@ -34,6 +57,12 @@ void OutputNode::preview() {
         return;
     }
 
+    if (textureDirty) {
+        if (textureID) glDeleteTextures(1, &textureID); // cleanup old
+        textureID = matToTexture(image);
+        textureDirty = false;
+    }
+
     if (textureID && glIsTexture(textureID)) {
         ImGui::Text("Preview:");
         ImGui::Image(
@@ -44,30 +73,81 @@ void OutputNode::preview() {
     }
 }
 
-void OutputNode::saveImage() {
-    if (image.empty()) {
-        std::cerr << "Cannot save: no image available\n";
-        return;
+std::string OutputNode::fileExtension() const {
+    return format == "JPG" ? ".jpg" : format == "PNG" ? ".png" :
+           format == "BMP" ? ".bmp" : format == "RAW" ? ".nbraw" : ".tif";
+}
+
+std::string OutputNode::outputPath(int frame) const {
+    std::string base = filename;
+    std::string extension = fileExtension();
+
+    bool hasExtension = base.find(extension) != std::string::npos;
+    if (frame >= 0) {
+        if (hasExtension) base = base.substr(0, base.rfind(extension));
+        char suffix[16];
+        std::snprintf(suffix, sizeof(suffix), "_%04d", frame);
+        return base + suffix + extension;
     }
+    return hasExtension ? base : base + extension;
+}
 
-    std::vector<int> params;
-    std::string fullFilename = filename;
+std::string OutputNode::batchOutputPath(const std::string& sourcePath, int index) const {
+    std::filesystem::path source(sourcePath);
+    std::string dir = source.has_parent_path() ? source.parent_path().string() : ".";
+
+    char number[16];
+    std::snprintf(number, sizeof(number), "%06d", index);
+
+    std::string path = batchPattern;
+    auto expand = [&](const std::string& token, const std::string& value) {
+        for (size_t pos = path.find(token); pos != std::string::npos; pos = path.find(token, pos + value.size())) {
+            path.replace(pos, token.size(), value);
+        }
+    };
+    expand("{dir}", dir);
+    expand("{name}", source.stem().string());
+    expand("{index}", number);
+    return path + fileExtension();
+}
 
+std::vector<int> OutputNode::encodeParams() const {
+    std::vector<int> params;
     if (format == "JPG") {
         params.push_back(cv::IMWRITE_JPEG_QUALITY);
         params.push_back(jpgQuality);
-        if (filename.find(".jpg") == std::string::npos) fullFilename += ".jpg";
-    } else if (format == "PNG") {
-        if (filename.find(".png") == std::string::npos) fullFilename += ".png";
-    } else if (format == "BMP") {
-        if (filename.find(".bmp") == std::string::npos) fullFilename += ".bmp";
     }
+    return params;
+}
 
-    if (!cv::imwrite(fullFilename, image, params)) {
-        std::cerr << "Failed to save image\n";
-    } else {
-        std::cout << "Saved to " << fullFilename << "\n";
+void OutputNode::saveImage() {
+    if (image.empty()) {
+        std::cerr << "Cannot save: no image available\n";
+        return;
     }
+    if (proxyScale > 1) {
+        // the image is a reduced-resolution preview, not the real result
+        std::cerr << "Cannot save: switch Preview Resolution to Full first\n";
+        return;
+    }
+
+    // encoding happens on the pool; the callback may outlive this node
+    auto status = saveStatus;
+    {
+        std::lock_guard<std::mutex> lock(status->mutex);
+        ++status->pending;
+    }
+
+    EncoderPool::Job job { outputPath(), format, encodeParams(), image };
+    EncoderPool::shared().submit(std::move(job), [status](const EncoderPool::Result& result) {
+        std::lock_guard<std::mutex> lock(status->mutex);
+        --status->pending;
+        status->lastMessage = result.ok
+            ? "Saved to " + result.path
+            : "Failed to save " + result.path;
+        status->lastSeconds = result.seconds;
+        if (result.ok) std::cout << status->lastMessage << "\n";
+    });
 }
 
 void OutputNode::renderPropertiesUI() {
@@ -81,7 +161,7 @@ void OutputNode::renderPropertiesUI() {
         filename = filenameBuffer;
     }
 
-    const char* formats[] = { "JPG", "PNG", "BMP" };
+    const char* formats[] = { "JPG", "PNG", "BMP", "TIFF", "RAW" };
     static int currentFormat = 0;
 
     if (ImGui::Combo("Format", &currentFormat, formats, IM_ARRAYSIZE(formats))) {
@@ -90,17 +170,47 @@ void OutputNode::renderPropertiesUI() {
 
     if (format == "JPG") {
         ImGui::SliderInt("JPG Quality", &jpgQuality, 0, 100);
+    } else if (format == "RAW") {
+        ImGui::TextDisabled("Uncompressed .nbraw: Input nodes map it with no decode");
     }
 
+    char patternBuffer[256];
+    std::strncpy(patternBuffer, batchPattern.c_str(), sizeof(patternBuffer));
+    patternBuffer[sizeof(patternBuffer) - 1] = '\0';
+    if (ImGui::InputText("Batch Pattern", patternBuffer, sizeof(patternBuffer))) {
+        batchPattern = patternBuffer;
+    }
+    ImGui::TextDisabled("Batch renders: {dir}, {name}, {index} per source file");
+
+    ImGui::BeginDisabled(proxyScale > 1);
     if (ImGui::Button("Save Image")) {
         saveImage();
     }
+    ImGui::EndDisabled();
+    if (proxyScale > 1) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("(set Preview Resolution to Full to save)");
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(saveStatus->mutex);
+        if (saveStatus->pending > 0) {
+            ImGui::Text("Saving %d image(s)...", saveStatus->pending);
+        } else if (!saveStatus->lastMessage.empty()) {
+            ImGui::Text("%s (%.2f s)", saveStatus->lastMessage.c_str(), saveStatus->lastSeconds);
+        }
+    }
+    EncoderPool& pool = EncoderPool::shared();
+    ImGui::TextDisabled("Encoder pool: %d threads, %d queued, %d done",
+        pool.getThreadCount(), pool.getPendingCount(), pool.getCompletedCount());
 
     if (image.empty()) {
         ImGui::Text("No image yet.");
+    } else if (proxyScale > 1) {
+        ImGui::TextColored(ImVec4(1, 0.8f, 0.3f, 1), "Proxy preview: image is 1/%d resolution", proxyScale);
     }
 }
 
-cv::Mat OutputNode::getOutput() const {
+cv::Mat OutputNode::getOutput(int) const {
     return image;
 }
\ No newline at end of file
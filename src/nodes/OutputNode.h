@@ -2,24 +2,55 @@
 #include <opencv2/opencv.hpp>
 #include "../core/Node.h"
 #include <GL/gl.h>
+#include <memory>
+#include <mutex>
 
 class OutputNode : public Node {
 private:
     cv::Mat image;
     GLuint textureID = 0;
+    bool textureDirty = false; // uploads happen in preview() so evaluation stays GL-free
     std::string filename = "output";
     std::string format = "JPG";
     int jpgQuality = 95;
+    // batch renders: {dir}, {name} and {index} expand per source file
+    std::string batchPattern = "{dir}/out/{name}";
+
+    // written from encoder threads, read by the properties panel
+    struct SaveStatus {
+        std::mutex mutex;
+        int pending = 0;
+        std::string lastMessage;
+        double lastSeconds = 0.0;
+    };
+    std::shared_ptr<SaveStatus> saveStatus = std::make_shared<SaveStatus>();
 
 public:
     OutputNode(int id, const std::string& name = "Output");
 
     void setInputs(const std::vector<cv::Mat>& input) override;
     void process() override;
-    cv::Mat getOutput() const override;
+    void compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>& requested) const override;
+    std::shared_ptr<Node> clone() const override;
+    const char* typeName() const override { return "Output"; }
+    void writeParameters(cv::FileStorage& fs) const override;
+    void readParameters(const cv::FileNode& node) override;
+    cv::Mat getOutput(int port = 0) const override;
+    int outputCount() const override { return 0; }
+    const char* inputName(int) const override { return "Input"; }
     GLuint getTextureID() const { return textureID; }
     void preview() override;
+    // Queues the current image on the shared encoder pool and returns immediately.
+    // Refuses while a proxy preview is active: the image is not full resolution.
     void saveImage();
+    // Target file for the current settings; frame >= 0 appends a _0001-style suffix.
+    std::string outputPath(int frame = -1) const;
+    // Target file for one source file of a batch render, from the batch pattern.
+    std::string batchOutputPath(const std::string& sourcePath, int index) const;
+    std::vector<int> encodeParams() const;
+    // ".jpg", ".png", ... for the current format.
+    std::string fileExtension() const;
+    const std::string& getFormat() const { return format; }
     void renderPropertiesUI() override;
 
     ~OutputNode() override {
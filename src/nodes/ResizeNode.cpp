@@ -0,0 +1,178 @@
+#include "ResizeNode.h"
+#include "../utils/TextureUtils.h"
+#include "imgui.h"
+#include <algorithm>
+#include <cmath>
+
+static const char* kFilterNames[] = { "Nearest", "Bilinear", "Bicubic", "Lanczos", "Area" };
+
+ResizeNode::ResizeNode(int id, const std::string& name) : Node(id, name) {}
+
+std::shared_ptr<Node> ResizeNode::clone() const {
+    auto copy = std::make_shared<ResizeNode>(id, name);
+    copy->filter = filter;
+    copy->scale = scale;
+    copy->width = width;
+    copy->height = height;
+    return copy;
+}
+
+void ResizeNode::writeParameters(cv::FileStorage& fs) const {
+    fs << "filter" << (int)filter << "scale" << scale << "width" << width << "height" << height;
+}
+
+void ResizeNode::readParameters(const cv::FileNode& node) {
+    int filterIndex = (int)filter;
+    cv::read(node["filter"], filterIndex, filterIndex);
+    filter = static_cast<ResampleFilter>(std::clamp(filterIndex, 0, 4));
+    cv::read(node["scale"], scale, scale);
+    cv::read(node["width"], width, width);
+    cv::read(node["height"], height, height);
+}
+
+void ResizeNode::setInputs(const std::vector<cv::Mat>& input) {
+    if (!input.empty()) {
+        inputImage = input[0];
+    } else {
+        inputImage.release();
+    }
+}
+
+cv::Size ResizeNode::targetSize(cv::Size source, double pixelScale) const {
+    double aspect = (double)source.width / source.height;
+    int w = (int)std::lround(width * pixelScale), h = (int)std::lround(height * pixelScale);
+    cv::Size size;
+    if (width > 0 && height > 0) {
+        size = cv::Size(w, h);
+    } else if (width > 0) {
+        size = cv::Size(w, (int)std::lround(w / aspect));
+    } else if (height > 0) {
+        size = cv::Size((int)std::lround(h * aspect), h);
+    } else {
+        size = cv::Size((int)std::lround(source.width * scale), (int)std::lround(source.height * scale));
+    }
+    return cv::Size(std::max(size.width, 1), std::max(size.height, 1));
+}
+
+ResizeNode::Tables ResizeNode::tablesFor(cv::Size from, cv::Size to) const {
+    std::lock_guard<std::mutex> lock(tablesMutex);
+    if (!tables.x || tables.from != from || tables.to != to || tables.filter != filter) {
+        tables.from = from;
+        tables.to = to;
+        tables.filter = filter;
+        tables.x = std::make_shared<const ResampleTable>(ResampleTable::build(from.width, to.width, filter));
+        tables.y = std::make_shared<const ResampleTable>(ResampleTable::build(from.height, to.height, filter));
+    }
+    return tables;
+}
+
+bool ResizeNode::apply(const cv::Mat& input, cv::Mat& output, double pixelScale) const {
+    if (input.empty()) {
+        output.release();
+        return true;
+    }
+
+    cv::Size from = imageSize(input);
+    cv::Size to = targetSize(from, pixelScale);
+    if (from == to) {
+        output = input;
+        return false;
+    }
+
+    Tables current = tablesFor(from, to);
+    bool planar = isPlanar(input);
+    if (planar) {
+        createPlanar(output, to, imageChannels(input), input.depth());
+    }
+
+    bool handled = dispatchPixelType(input.depth(), imageChannels(input), [&](auto pixel) {
+        using P = decltype(pixel);
+        using T = typename P::Type;
+        if (planar) {
+            for (int c = 0; c < P::channels; ++c) {
+                cv::Mat dst = planeView(output, c);
+                resampleKernel<T, 1>(planeView(input, c), dst, *current.x, *current.y);
+            }
+        } else {
+            resampleKernel<T, P::channels>(input, output, *current.x, *current.y);
+        }
+    });
+    if (handled) return true;
+
+    static const int kInterpolation[] = { cv::INTER_NEAREST, cv::INTER_LINEAR, cv::INTER_CUBIC, cv::INTER_LANCZOS4, cv::INTER_AREA };
+    int interpolation = kInterpolation[(int)filter];
+    if (planar) {
+        for (int c = 0; c < imageChannels(input); ++c) {
+            cv::Mat dst = planeView(output, c);
+            cv::resize(planeView(input, c), dst, to, 0, 0, interpolation);
+        }
+    } else {
+        cv::resize(input, output, to, 0, 0, interpolation);
+    }
+    return true;
+}
+
+void ResizeNode::process() {
+    if (outputIsInput) {
+        outputImage.release(); // still an earlier input; don't resample into it
+    }
+    // a proxy image is 1/proxyScale the size; absolute targets shrink with it
+    outputIsInput = !apply(inputImage, outputImage, 1.0 / proxyScale);
+}
+
+void ResizeNode::compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>&) const {
+    releaseUnlessExclusive(outputs[0]);
+    apply(inputs[0], outputs[0], 1.0);
+}
+
+cv::Mat ResizeNode::getOutput(int) const {
+    return outputImage;
+}
+
+void ResizeNode::preview() {
+    if (outputImage.empty()) {
+        ImGui::Text("No output");
+        return;
+    }
+
+    if (textureID) glDeleteTextures(1, &textureID);
+    textureID = matToTexture(outputImage);
+
+    if (textureID && glIsTexture(textureID)) {
+        ImGui::Text("Preview:");
+        ImGui::Image((ImTextureID)(intptr_t)textureID, ImVec2(128, 128), ImVec2(1, 0), ImVec2(0, 1));
+    }
+}
+
+void ResizeNode::renderPropertiesUI() {
+    ImGui::Text("Resize");
+
+    bool updated = false;
+
+    int filterIndex = (int)filter;
+    if (ImGui::Combo("Filter", &filterIndex, kFilterNames, IM_ARRAYSIZE(kFilterNames))) {
+        filter = static_cast<ResampleFilter>(filterIndex);
+        updated = true;
+    }
+    updated |= ImGui::SliderFloat("Scale", &scale, 0.05f, 4.0f, "%.3f", ImGuiSliderFlags_Logarithmic);
+    updated |= ImGui::InputInt("Width (0 = scale)", &width);
+    updated |= ImGui::InputInt("Height (0 = scale)", &height);
+    width = std::max(width, 0);
+    height = std::max(height, 0);
+
+    if (ImGui::Button("Reset")) {
+        filter = ResampleFilter::Area;
+        scale = 0.5f;
+        width = height = 0;
+        updated = true;
+    }
+
+    if (updated) {
+        markDirty();
+    }
+
+    if (!inputImage.empty()) {
+        cv::Size from = imageSize(inputImage), to = targetSize(from, 1.0 / proxyScale);
+        ImGui::Text("%d x %d -> %d x %d", from.width, from.height, to.width, to.height);
+    }
+}
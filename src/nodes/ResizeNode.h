@@ -0,0 +1,56 @@
+#pragma once
+#include "../core/Node.h"
+#include "../utils/ResampleKernels.h"
+#include <opencv2/opencv.hpp>
+#include <GL/gl.h>
+#include <memory>
+#include <mutex>
+
+// Rescales the image, so expensive filters downstream can run on fewer
+// pixels. Target size is a scale factor, or a width and/or height (a missing
+// one follows the aspect ratio). Resampling is separable with per-axis weight
+// tables that are rebuilt only when the sizes or the filter change.
+class ResizeNode : public Node {
+private:
+    cv::Mat inputImage, outputImage;
+    bool outputIsInput = false; // the last process() passed its input through
+    GLuint textureID = 0;
+
+    ResampleFilter filter = ResampleFilter::Area;
+    float scale = 0.5f;
+    int width = 0, height = 0;   // > 0 overrides the scale
+
+    struct Tables {
+        cv::Size from, to;
+        ResampleFilter filter;
+        std::shared_ptr<const ResampleTable> x, y;
+    };
+    // shared by execution contexts: compute() may run on many threads
+    mutable std::mutex tablesMutex;
+    mutable Tables tables;
+
+    // width and height are full-resolution pixels; pixelScale shrinks them
+    // for a proxy preview (the scale factor applies as is)
+    cv::Size targetSize(cv::Size source, double pixelScale) const;
+    Tables tablesFor(cv::Size from, cv::Size to) const;
+    // False when output is just input, passed through.
+    bool apply(const cv::Mat& input, cv::Mat& output, double pixelScale) const;
+
+public:
+    ResizeNode(int id, const std::string& name = "Resize");
+
+    void setInputs(const std::vector<cv::Mat>& input) override;
+    void process() override;
+    void compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>& requested) const override;
+    std::shared_ptr<Node> clone() const override;
+    const char* typeName() const override { return "Resize"; }
+    void writeParameters(cv::FileStorage& fs) const override;
+    void readParameters(const cv::FileNode& node) override;
+    cv::Mat getOutput(int port = 0) const override;
+    void preview() override;
+    void renderPropertiesUI() override;
+
+    ~ResizeNode() override {
+        if (textureID) glDeleteTextures(1, &textureID);
+    }
+};
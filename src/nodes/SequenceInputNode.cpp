@@ -0,0 +1,158 @@
+#include "SequenceInputNode.h"
+#include <iostream>
+#include "../utils/TextureUtils.h"
+#include "../utils/SourceImage.h"
+#include "imgui.h"
+
+SequenceInputNode::SequenceInputNode(int id, const std::string& defaultSource, const std::string& name)
+    : Node(id, name), source(defaultSource) {}
+
+std::shared_ptr<Node> SequenceInputNode::clone() const {
+    // the copy opens its own prefetcher on demand
+    auto copy = std::make_shared<SequenceInputNode>(id, source, name);
+    copy->prefetchFrames = prefetchFrames;
+    copy->decodeThreads = decodeThreads;
+    copy->loop = loop;
+    return copy;
+}
+
+void SequenceInputNode::writeParameters(cv::FileStorage& fs) const {
+    fs << "source" << source << "prefetchFrames" << prefetchFrames
+       << "decodeThreads" << decodeThreads << "loop" << (int)loop;
+}
+
+void SequenceInputNode::readParameters(const cv::FileNode& node) {
+    cv::read(node["source"], source, source);
+    cv::read(node["prefetchFrames"], prefetchFrames, prefetchFrames);
+    cv::read(node["decodeThreads"], decodeThreads, decodeThreads);
+    cv::read(node["loop"], loop, loop);
+}
+
+void SequenceInputNode::open() {
+    prefetcher.reset();
+    image.release();
+    ++version;
+    currentFrame = 0;
+    displayedFrame = -1;
+    if (source.empty()) return;
+
+    // decoder threads also do the format conversion, off the UI thread
+    WorkingFormat format = openedFormat = workingFormat;
+    bool planar = openedPlanar = planarLayout;
+    int proxy = openedProxy = proxyScale;
+    prefetcher = std::make_unique<FramePrefetcher>(source, prefetchFrames, decodeThreads,
+        [format, planar, proxy](cv::Mat frame) { return prepareSourceImage(frame, format, planar, proxy); });
+
+    if (!prefetcher->isOpen()) {
+        prefetcher.reset();
+    }
+}
+
+void SequenceInputNode::process() {
+    if (!prefetcher) return;
+
+    if (openedFormat != workingFormat || openedPlanar != planarLayout || openedProxy != proxyScale) {
+        // buffered frames were converted for the old settings
+        int frame = currentFrame;
+        open();
+        if (!prefetcher) return;
+        currentFrame = frame;
+    }
+
+    int frameCount = prefetcher->getFrameCount();
+    int wanted = currentFrame;
+    if (playing && displayedFrame == currentFrame) {
+        wanted = currentFrame + 1;
+        if (wanted >= frameCount) {
+            wanted = loop ? 0 : currentFrame;
+        }
+    }
+
+    // never block the UI: keep showing the last frame until the next is ready
+    cv::Mat frame;
+    if (wanted != displayedFrame && prefetcher->tryGetFrame(wanted, frame)) {
+        image = frame;
+        currentFrame = displayedFrame = wanted;
+        textureDirty = true;
+        ++version;
+    }
+}
+
+bool SequenceInputNode::seekFrame(int frame) {
+    if (!prefetcher) return false;
+
+    playing = false;
+    image = prefetcher->getFrame(frame);
+    currentFrame = displayedFrame = frame;
+    textureDirty = true;
+    ++version;
+    return !image.empty();
+}
+
+void SequenceInputNode::compute(const std::vector<cv::Mat>&, std::vector<cv::Mat>& outputs, const std::vector<bool>&) const {
+    outputs[0] = image;
+}
+
+cv::Mat SequenceInputNode::getOutput(int) const {
+    return image;
+}
+
+void SequenceInputNode::preview() {
+    if (image.empty()) {
+        ImGui::Text("No preview");
+        return;
+    }
+
+    if (textureDirty) {
+        if (textureID) glDeleteTextures(1, &textureID);
+        textureID = matToTexture(image);
+        textureDirty = false;
+    }
+
+    if (textureID && glIsTexture(textureID)) {
+        ImGui::Text("Frame %d", displayedFrame);
+        ImGui::Image(
+            (ImTextureID)(intptr_t)textureID,
+            ImVec2(128, 128),
+            ImVec2(1, 0), ImVec2(0, 1)
+        );
+    }
+}
+
+void SequenceInputNode::renderPropertiesUI() {
+    ImGui::Text("Sequence Input");
+
+    char buf[512];
+    std::strncpy(buf, source.c_str(), sizeof(buf));
+    buf[sizeof(buf) - 1] = '\0';
+    if (ImGui::InputText("Source", buf, sizeof(buf))) {
+        source = buf;
+    }
+    ImGui::TextDisabled("e.g. shots/plate_####.png or clip.mp4");
+
+    ImGui::SliderInt("Prefetch Frames", &prefetchFrames, 1, 64);
+    ImGui::SliderInt("Decode Threads", &decodeThreads, 1, 16);
+
+    if (ImGui::Button("Open")) {
+        open();
+    }
+
+    if (!prefetcher) {
+        ImGui::Text("No sequence loaded.");
+        return;
+    }
+
+    ImGui::Separator();
+    int last = prefetcher->getFrameCount() - 1;
+    ImGui::SliderInt("Frame", &currentFrame, 0, last);
+    ImGui::Checkbox("Play", &playing);
+    ImGui::SameLine();
+    ImGui::Checkbox("Loop", &loop);
+
+    ImGui::Text("Frames: %d (first %d)", last + 1, prefetcher->getFirstFrame());
+    ImGui::Text("Buffered: %d / %d", prefetcher->bufferedCount(), prefetcher->getCapacity());
+    if (!image.empty()) {
+        ImGui::Text("Dimensions: %d x %d", imageSize(image).width, imageSize(image).height);
+        ImGui::Text("Channels: %d", imageChannels(image));
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include "../core/Node.h"
+#include "../utils/FramePrefetcher.h"
+#include <GL/gl.h>
+#include <memory>
+
+class SequenceInputNode : public Node {
+private:
+    cv::Mat image;
+    std::string source;
+    GLuint textureID = 0;
+    bool textureDirty = false;
+
+    std::unique_ptr<FramePrefetcher> prefetcher;
+    int prefetchFrames = 16;
+    int decodeThreads = 4;
+    int currentFrame = 0;
+    int displayedFrame = -1;
+    bool playing = false;
+    bool loop = true;
+    // settings the prefetcher's decoders were started with
+    WorkingFormat openedFormat = WorkingFormat::U8;
+    bool openedPlanar = false;
+    int openedProxy = 1;
+
+    void open();
+
+public:
+    SequenceInputNode(int id, const std::string& defaultSource = "", const std::string& name = "Sequence Input");
+
+    void process() override;
+    void compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>& requested) const override;
+    std::shared_ptr<Node> clone() const override;
+    const char* typeName() const override { return "SequenceInput"; }
+    void writeParameters(cv::FileStorage& fs) const override;
+    void readParameters(const cv::FileNode& node) override;
+    cv::Mat getOutput(int port = 0) const override;
+    int inputCount() const override { return 0; }
+    const char* outputName(int) const override { return "Output"; }
+    void renderPropertiesUI() override;
+    void preview() override;
+
+    int getFrameCount() const { return prefetcher ? prefetcher->getFrameCount() : 0; }
+    // Number of the sequence's first file (e.g. 1001 for shot_1001.exr); 0 for videos.
+    int getFirstFrame() const { return prefetcher ? prefetcher->getFirstFrame() : 0; }
+    // Blocks until the frame is decoded; used by batch rendering.
+    bool seekFrame(int frame);
+
+    ~SequenceInputNode() override {
+        if (textureID) glDeleteTextures(1, &textureID);
+    }
+};
@@ -0,0 +1,90 @@
+#include "SplitChannelsNode.h"
+#include "../utils/TextureUtils.h"
+#include "../utils/PixelKernels.h"
+#include "imgui.h"
+#include <algorithm>
+
+SplitChannelsNode::SplitChannelsNode(int id, const std::string& name) : Node(id, name) {}
+
+std::shared_ptr<Node> SplitChannelsNode::clone() const {
+    return std::make_shared<SplitChannelsNode>(id, name);
+}
+
+void SplitChannelsNode::setInputs(const std::vector<cv::Mat>& input) {
+    if (!input.empty()) {
+        inputImage = input[0];
+    } else {
+        inputImage.release();
+    }
+}
+
+void SplitChannelsNode::compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>& requested) const {
+    const cv::Mat& input = inputs[0];
+    for (int c = 0; c < kMaxChannels; ++c) {
+        // only extract the planes something downstream is linked to
+        bool wanted = c < (int)requested.size() && requested[c];
+        if (input.empty() || c >= imageChannels(input) || !wanted) {
+            outputs[c].release();
+            continue;
+        }
+        if (isPlanar(input)) {
+            // already contiguous: a plain copy of the plane
+            outputs[c] = planeView(input, c).clone();
+            continue;
+        }
+        bool handled = dispatchPixelType(input.depth(), input.channels(), [&](auto pixel) {
+            using P = decltype(pixel);
+            extractChannelKernel<typename P::Type, P::channels>(input, outputs[c], c);
+        });
+        if (!handled) {
+            cv::extractChannel(input, outputs[c], c);
+        }
+    }
+}
+
+void SplitChannelsNode::process() {
+    std::vector<cv::Mat> outputs(channels, channels + kMaxChannels);
+    compute({ inputImage }, outputs, requestedOutputs);
+    std::copy(outputs.begin(), outputs.end(), channels);
+}
+
+cv::Mat SplitChannelsNode::getOutput(int port) const {
+    if (port < 0 || port >= kMaxChannels) return cv::Mat();
+    return channels[port];
+}
+
+const char* SplitChannelsNode::outputName(int port) const {
+    static const char* names[kMaxChannels] = { "B", "G", "R", "A" };
+    return port >= 0 && port < kMaxChannels ? names[port] : "Out";
+}
+
+void SplitChannelsNode::preview() {
+    if (inputImage.empty()) {
+        ImGui::Text("No input");
+        return;
+    }
+
+    if (textureID) glDeleteTextures(1, &textureID);
+    textureID = matToTexture(inputImage);
+
+    if (textureID && glIsTexture(textureID)) {
+        ImGui::Text("Preview:");
+        ImGui::Image((ImTextureID)(intptr_t)textureID, ImVec2(128, 128), ImVec2(1, 0), ImVec2(0, 1));
+    }
+}
+
+void SplitChannelsNode::renderPropertiesUI() {
+    ImGui::Text("Split Channels");
+
+    if (inputImage.empty()) {
+        ImGui::Text("No input image yet.");
+        return;
+    }
+
+    ImGui::Text("Input channels: %d", imageChannels(inputImage));
+    for (int c = 0; c < kMaxChannels; ++c) {
+        ImGui::Text("%s: %s", outputName(c),
+            c >= imageChannels(inputImage) ? "unavailable" :
+            isOutputRequested(c) ? "computed" : "skipped (not linked)");
+    }
+}
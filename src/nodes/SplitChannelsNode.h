@@ -0,0 +1,32 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include "../core/Node.h"
+#include <GL/gl.h>
+#include <vector>
+
+class SplitChannelsNode : public Node {
+private:
+    static constexpr int kMaxChannels = 4;
+
+    cv::Mat inputImage;
+    cv::Mat channels[kMaxChannels];
+    GLuint textureID = 0;
+
+public:
+    SplitChannelsNode(int id, const std::string& name = "Split Channels");
+
+    void setInputs(const std::vector<cv::Mat>& input) override;
+    void process() override;
+    void compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>& requested) const override;
+    std::shared_ptr<Node> clone() const override;
+    const char* typeName() const override { return "SplitChannels"; }
+    cv::Mat getOutput(int port = 0) const override;
+    int outputCount() const override { return kMaxChannels; }
+    const char* outputName(int port) const override;
+    void preview() override;
+    void renderPropertiesUI() override;
+
+    ~SplitChannelsNode() override {
+        if (textureID) glDeleteTextures(1, &textureID);
+    }
+};
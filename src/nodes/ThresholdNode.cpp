@@ -0,0 +1,155 @@
+#include "ThresholdNode.h"
+#include "../utils/TextureUtils.h"
+#include "../utils/ThresholdKernels.h"
+#include "imgui.h"
+#include <algorithm>
+
+static const char* kModeNames[] = { "Fixed", "Otsu", "Adaptive" };
+
+ThresholdNode::ThresholdNode(int id, const std::string& name) : Node(id, name) {}
+
+std::shared_ptr<Node> ThresholdNode::clone() const {
+    auto copy = std::make_shared<ThresholdNode>(id, name);
+    copy->mode = mode;
+    copy->level = level;
+    copy->radius = radius;
+    copy->offset = offset;
+    copy->invert = invert;
+    return copy;
+}
+
+void ThresholdNode::writeParameters(cv::FileStorage& fs) const {
+    fs << "mode" << (int)mode << "level" << level << "radius" << radius
+       << "offset" << offset << "invert" << (int)invert;
+}
+
+void ThresholdNode::readParameters(const cv::FileNode& node) {
+    int modeIndex = (int)mode;
+    cv::read(node["mode"], modeIndex, modeIndex);
+    mode = static_cast<Mode>(std::clamp(modeIndex, 0, 2));
+    cv::read(node["level"], level, level);
+    cv::read(node["radius"], radius, radius);
+    cv::read(node["offset"], offset, offset);
+    cv::read(node["invert"], invert, invert);
+}
+
+void ThresholdNode::setInputs(const std::vector<cv::Mat>& input) {
+    if (!input.empty()) {
+        inputImage = input[0];
+    } else {
+        inputImage.release();
+    }
+}
+
+void ThresholdNode::apply(const cv::Mat& input, cv::Mat& output, IntegralImagePtr sums, int window) const {
+    if (input.empty()) {
+        output.release();
+        return;
+    }
+
+    bool handled = dispatchPixelType(input.depth(), imageChannels(input), [&](auto pixel) {
+        using P = decltype(pixel);
+        using T = typename P::Type;
+        const float maxValue = PixelTraits<T>::maxValue;
+
+        if (mode == Mode::Adaptive) {
+            if (!sums) sums = std::make_shared<const IntegralImage>(IntegralImage::computeGray(input));
+            adaptiveThresholdKernel<T, P::channels>(input, output, *sums, window, offset * maxValue, invert);
+            lastLevel = -1.0f;
+            return;
+        }
+
+        float fraction = level;
+        if (mode == Mode::Otsu) {
+            int bins = histogramBins(input.depth());
+            auto histogram = grayHistogram<T, P::channels>(input, bins);
+            // bin b holds values that round to b: the cut sits half a bin up
+            fraction = (otsuThreshold(histogram) + 0.5f) / (bins - 1);
+        }
+        lastLevel = fraction;
+        thresholdKernel<T, P::channels>(input, output, fraction * maxValue, invert);
+    });
+    if (handled) return;
+
+    // unsupported depth or channel count: OpenCV on 8-bit gray
+    cv::Mat gray;
+    toInterleaved(input).convertTo(gray, CV_8U, input.depth() == CV_32F ? 255.0 : (input.depth() == CV_16U ? 1.0 / 257.0 : 1.0));
+    if (gray.channels() > 1) cv::cvtColor(gray, gray, gray.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+    int type = invert ? cv::THRESH_BINARY_INV : cv::THRESH_BINARY;
+    if (mode == Mode::Adaptive) {
+        cv::adaptiveThreshold(gray, output, 255, cv::ADAPTIVE_THRESH_MEAN_C, type, window * 2 + 1, offset * 255.0);
+    } else {
+        double used = cv::threshold(gray, output, level * 255.0, 255, type | (mode == Mode::Otsu ? cv::THRESH_OTSU : 0));
+        lastLevel = (float)(used / 255.0);
+    }
+}
+
+void ThresholdNode::process() {
+    apply(inputImage, outputImage, inputIntegral(0), proxyPixels(radius));
+}
+
+void ThresholdNode::compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>&) const {
+    apply(inputs[0], outputs[0], nullptr, radius);
+}
+
+void ThresholdNode::computeWithIntegrals(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs,
+                                         const std::vector<bool>&, const std::vector<IntegralImagePtr>& integrals) const {
+    apply(inputs[0], outputs[0], integrals[0], radius);
+}
+
+cv::Mat ThresholdNode::getOutput(int) const {
+    return outputImage;
+}
+
+void ThresholdNode::preview() {
+    if (outputImage.empty()) {
+        ImGui::Text("No output");
+        return;
+    }
+
+    if (textureID) glDeleteTextures(1, &textureID);
+    textureID = matToTexture(outputImage);
+
+    if (textureID && glIsTexture(textureID)) {
+        ImGui::Text("Preview:");
+        ImGui::Image((ImTextureID)(intptr_t)textureID, ImVec2(128, 128), ImVec2(1, 0), ImVec2(0, 1));
+    }
+}
+
+void ThresholdNode::renderPropertiesUI() {
+    ImGui::Text("Threshold");
+
+    bool updated = false;
+
+    int modeIndex = (int)mode;
+    if (ImGui::Combo("Mode", &modeIndex, kModeNames, IM_ARRAYSIZE(kModeNames))) {
+        mode = static_cast<Mode>(modeIndex);
+        updated = true;
+    }
+
+    switch (mode) {
+        case Mode::Fixed:
+            updated |= ImGui::SliderFloat("Level", &level, 0.0f, 1.0f);
+            break;
+        case Mode::Otsu:
+            if (!outputImage.empty()) ImGui::Text("Otsu level: %.3f", lastLevel.load());
+            break;
+        case Mode::Adaptive:
+            updated |= ImGui::SliderInt("Radius", &radius, 1, 100);
+            updated |= ImGui::SliderFloat("Offset", &offset, -0.25f, 0.25f);
+            break;
+    }
+    updated |= ImGui::Checkbox("Invert", &invert);
+
+    if (ImGui::Button("Reset")) {
+        level = 0.5f;
+        radius = 7;
+        offset = 0.02f;
+        invert = false;
+        updated = true;
+    }
+
+    if (updated) {
+        markDirty();
+    }
+}
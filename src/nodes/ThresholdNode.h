@@ -0,0 +1,55 @@
+#pragma once
+#include "../core/Node.h"
+#include <opencv2/opencv.hpp>
+#include <GL/gl.h>
+#include <atomic>
+
+// Binary mask from the luminance of the input: a fixed level, Otsu's level
+// from the image histogram, or a local (adaptive) level from the window mean.
+// The output has a single channel at the input's depth.
+class ThresholdNode : public Node {
+public:
+    enum class Mode { Fixed, Otsu, Adaptive };
+
+private:
+    cv::Mat inputImage, outputImage;
+    GLuint textureID = 0;
+
+    Mode mode = Mode::Fixed;
+    float level = 0.5f;    // Fixed, fraction of the maximum value
+    int radius = 7;        // Adaptive window half-size
+    float offset = 0.02f;  // Adaptive, subtracted from the window mean
+    bool invert = false;
+    // level the last evaluation used (Otsu's choice), for the UI
+    mutable std::atomic<float> lastLevel{0.0f};
+
+    // sums: the input's summed-area table if the graph shared one; window is
+    // the Adaptive radius at the input's resolution
+    void apply(const cv::Mat& input, cv::Mat& output, IntegralImagePtr sums, int window) const;
+
+public:
+    ThresholdNode(int id, const std::string& name = "Threshold");
+
+    void setInputs(const std::vector<cv::Mat>& input) override;
+    void process() override;
+    void compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>& requested) const override;
+    IntegralKind inputIntegralKind(int) const override {
+        return mode == Mode::Adaptive ? IntegralKind::Gray : IntegralKind::None;
+    }
+    void computeWithIntegrals(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs,
+                              const std::vector<bool>& requested, const std::vector<IntegralImagePtr>& integrals) const override;
+    std::shared_ptr<Node> clone() const override;
+    const char* typeName() const override { return "Threshold"; }
+    void writeParameters(cv::FileStorage& fs) const override;
+    void readParameters(const cv::FileNode& node) override;
+    cv::Mat getOutput(int port = 0) const override;
+    void preview() override;
+    void renderPropertiesUI() override;
+    int haloRows() const override { return mode == Mode::Adaptive ? radius : 0; }
+    // Otsu's level comes from the whole image's histogram; a strip would get its own
+    bool isStreamable() const override { return mode != Mode::Otsu; }
+
+    ~ThresholdNode() override {
+        if (textureID) glDeleteTextures(1, &textureID);
+    }
+};
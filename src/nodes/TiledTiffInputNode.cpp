@@ -0,0 +1,168 @@
+#include "TiledTiffInputNode.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include "../utils/TextureUtils.h"
+#include "../utils/SourceImage.h"
+#include "../utils/ThreadPool.h"
+#include "../utils/TiledTiff.h"
+#include "imgui.h"
+
+TiledTiffInputNode::TiledTiffInputNode(int id, const std::string& defaultPath, const std::string& name)
+    : Node(id, name), filepath(defaultPath) {}
+
+std::shared_ptr<Node> TiledTiffInputNode::clone() const {
+    auto copy = std::make_shared<TiledTiffInputNode>(id, filepath, name);
+    copy->previewX = previewX;
+    copy->previewY = previewY;
+    return copy;
+}
+
+void TiledTiffInputNode::writeParameters(cv::FileStorage& fs) const {
+    fs << "filepath" << filepath;
+    fs << "previewX" << previewX;
+    fs << "previewY" << previewY;
+}
+
+void TiledTiffInputNode::readParameters(const cv::FileNode& node) {
+    cv::read(node["filepath"], filepath, filepath);
+    cv::read(node["previewX"], previewX, previewX);
+    cv::read(node["previewY"], previewY, previewY);
+}
+
+TiledTiffInputNode::~TiledTiffInputNode() {
+    if (textureID) glDeleteTextures(1, &textureID);
+}
+
+void TiledTiffInputNode::setStreamedImage(const cv::Mat& strip) {
+    streaming = true;
+    image = strip;
+    textureDirty = true;
+    ++version;
+}
+
+void TiledTiffInputNode::endStreaming() {
+    streaming = false;
+    image.release();
+    ++version;
+    loadedPath.clear(); // re-read the preview window on the next process()
+}
+
+void TiledTiffInputNode::readHeader() {
+    headerPath = filepath;
+    fileSize = cv::Size();
+    fileType = -1;
+    if (filepath.empty()) return;
+
+    // the constructor reads tags only; no pixel data is decoded
+    TiffRegionReader reader(filepath);
+    if (reader.isOpen()) {
+        fileSize = reader.size();
+        fileType = reader.type();
+    }
+}
+
+void TiledTiffInputNode::load() {
+    if (filepath != headerPath) readHeader();
+
+    previewX = std::max(0, std::min(previewX, fileSize.width - kPreviewSize));
+    previewY = std::max(0, std::min(previewY, fileSize.height - kPreviewSize));
+    loadedPath = filepath;
+    loadedOrigin = cv::Point(previewX, previewY);
+    loadedFormat = workingFormat;
+    loadedPlanar = planarLayout;
+    loadedProxy = proxyScale;
+    if (fileType < 0) return;
+
+    cv::Rect window(previewX, previewY, kPreviewSize, kPreviewSize);
+    pendingLoad = ThreadPool::io().submit(
+        [path = filepath, window, format = workingFormat, planar = planarLayout, proxy = proxyScale] {
+            // one tile (or strip) at a time is enough: each is visited once
+            TiffRegionReader reader(path, 1);
+            return prepareSourceImage(reader.readRegion(window), format, planar, proxy);
+        });
+}
+
+void TiledTiffInputNode::waitForPendingWork() {
+    if (!streaming && pendingLoad.valid()) pendingLoad.wait();
+}
+
+void TiledTiffInputNode::process() {
+    if (streaming) return;
+
+    if (filepath != loadedPath || cv::Point(previewX, previewY) != loadedOrigin ||
+        workingFormat != loadedFormat || planarLayout != loadedPlanar || proxyScale != loadedProxy) {
+        load();
+    }
+
+    if (pendingLoad.valid() &&
+        pendingLoad.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        image = pendingLoad.get();
+        if (image.empty()) {
+            std::cerr << "Failed to read preview window of " << loadedPath << std::endl;
+        }
+        textureDirty = true;
+        ++version;
+    }
+}
+
+void TiledTiffInputNode::preview() {
+    if (image.empty()) {
+        ImGui::Text(pendingLoad.valid() ? "Loading..." : "No preview");
+        return;
+    }
+
+    if (textureDirty) {
+        if (textureID) glDeleteTextures(1, &textureID);
+        textureID = matToTexture(image);
+        textureDirty = false;
+    }
+
+    if (textureID && glIsTexture(textureID)) {
+        ImGui::Text("Preview:");
+        ImGui::Image(
+            (ImTextureID)(intptr_t)textureID,
+            ImVec2(128, 128),
+            ImVec2(1, 0), ImVec2(0, 1)
+        );
+    }
+}
+
+void TiledTiffInputNode::renderPropertiesUI() {
+    ImGui::Text("Tiled TIFF Input");
+
+    static char buf[256];
+    strncpy(buf, filepath.c_str(), sizeof(buf));
+    static std::string pendingPath;
+
+    if (ImGui::InputText("Filepath", buf, IM_ARRAYSIZE(buf))) {
+        pendingPath = std::string(buf);
+    }
+    if (ImGui::Button("Open")) {
+        filepath = pendingPath;
+    }
+
+    if (fileType < 0) {
+        if (!headerPath.empty()) {
+            ImGui::TextColored(ImVec4(1, 0.3f, 0.3f, 1), "Cannot stream %s", headerPath.c_str());
+        }
+        return;
+    }
+
+    ImGui::Separator();
+    ImGui::Text("Dimensions: %d x %d", fileSize.width, fileSize.height);
+    ImGui::Text("Channels: %d", CV_MAT_CN(fileType));
+    ImGui::Text("Working format: %s", formatName(workingFormat));
+
+    // the window is read on the next process(); the graph picks it up from there
+    ImGui::SliderInt("Preview X", &previewX, 0, std::max(0, fileSize.width - kPreviewSize));
+    ImGui::SliderInt("Preview Y", &previewY, 0, std::max(0, fileSize.height - kPreviewSize));
+}
+
+void TiledTiffInputNode::compute(const std::vector<cv::Mat>&, std::vector<cv::Mat>& outputs, const std::vector<bool>&) const {
+    outputs[0] = image;
+}
+
+cv::Mat TiledTiffInputNode::getOutput(int) const {
+    return image;
+}
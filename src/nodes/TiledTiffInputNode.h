@@ -0,0 +1,65 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include "../core/Node.h"
+#include <future>
+#include <string>
+#include <GL/gl.h>
+
+// Source for TIFFs too large to decode whole. Opening the file only reads its
+// header (size, sample layout); the editor previews a window of the image,
+// read tile by tile, so the graph can be tuned on real pixels. Full frames
+// only ever pass through TiledRenderer, which feeds the graph one strip at a
+// time with setStreamedImage().
+class TiledTiffInputNode : public Node {
+private:
+    cv::Mat image;
+    std::string filepath;
+    GLuint textureID = 0;
+    bool textureDirty = false;
+    bool streaming = false;
+
+    // header of filepath, read when the path changes
+    std::string headerPath;
+    cv::Size fileSize;
+    int fileType = -1;
+
+    // top-left of the preview window, in full-resolution pixels
+    int previewX = 0, previewY = 0;
+    static constexpr int kPreviewSize = 1024;
+
+    // window reads happen on the I/O pool; these record what the last one asked for
+    std::future<cv::Mat> pendingLoad;
+    std::string loadedPath;
+    cv::Point loadedOrigin{-1, -1};
+    WorkingFormat loadedFormat = WorkingFormat::U8;
+    bool loadedPlanar = false;
+    int loadedProxy = 1;
+
+    void readHeader();
+    void load();
+
+public:
+    TiledTiffInputNode(int id, const std::string& defaultPath = "", const std::string& name = "Tiled TIFF Input");
+
+    void process() override;
+    void compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>& requested) const override;
+    std::shared_ptr<Node> clone() const override;
+    const char* typeName() const override { return "TiledTiffInput"; }
+    void writeParameters(cv::FileStorage& fs) const override;
+    void readParameters(const cv::FileNode& node) override;
+    cv::Mat getOutput(int port = 0) const override;
+    int inputCount() const override { return 0; }
+    const char* outputName(int) const override { return "Output"; }
+    void renderPropertiesUI() override;
+    void preview() override;
+    void waitForPendingWork() override;
+
+    const std::string& getFilepath() const { return filepath; }
+
+    // Feed one prepared strip of the file instead of the preview window;
+    // endStreaming() goes back to previewing.
+    void setStreamedImage(const cv::Mat& strip);
+    void endStreaming();
+
+    ~TiledTiffInputNode() override;
+};
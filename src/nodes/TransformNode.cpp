@@ -0,0 +1,276 @@
+#include "TransformNode.h"
+#include "../utils/TextureUtils.h"
+#include "imgui.h"
+#include <algorithm>
+#include <climits>
+
+static const char* kModeNames[] = { "Rotate / Scale / Translate", "Affine", "Perspective", "Lens Undistort" };
+static const char* kInterpolationNames[] = { "Nearest", "Bilinear", "Bicubic" };
+static const char* kBorderNames[] = { "Transparent", "Replicate", "Reflect" };
+
+TransformNode::TransformNode(int id, const std::string& name) : Node(id, name) {}
+
+std::shared_ptr<Node> TransformNode::clone() const {
+    auto copy = std::make_shared<TransformNode>(id, name);
+    copy->mode = mode;
+    copy->interpolation = interpolation;
+    copy->border = border;
+    copy->angle = angle;
+    copy->scale = scale;
+    copy->translateX = translateX;
+    copy->translateY = translateY;
+    std::copy(std::begin(affine), std::end(affine), copy->affine);
+    std::copy(std::begin(corners), std::end(corners), copy->corners);
+    copy->focal = focal;
+    copy->k1 = k1;
+    copy->k2 = k2;
+    copy->p1 = p1;
+    copy->p2 = p2;
+    copy->k3 = k3;
+    return copy;
+}
+
+void TransformNode::writeParameters(cv::FileStorage& fs) const {
+    fs << "mode" << (int)mode << "interpolation" << interpolation << "border" << border
+       << "angle" << angle << "scale" << scale << "translateX" << translateX << "translateY" << translateY
+       << "affine" << std::vector<float>(std::begin(affine), std::end(affine))
+       << "corners" << std::vector<float>(std::begin(corners), std::end(corners))
+       << "focal" << focal << "k1" << k1 << "k2" << k2 << "p1" << p1 << "p2" << p2 << "k3" << k3;
+}
+
+void TransformNode::readParameters(const cv::FileNode& node) {
+    int modeIndex = (int)mode;
+    cv::read(node["mode"], modeIndex, modeIndex);
+    mode = static_cast<Mode>(std::clamp(modeIndex, 0, 3));
+    cv::read(node["interpolation"], interpolation, interpolation);
+    interpolation = std::clamp(interpolation, 0, 2);
+    cv::read(node["border"], border, border);
+    border = std::clamp(border, 0, 2);
+    cv::read(node["angle"], angle, angle);
+    cv::read(node["scale"], scale, scale);
+    cv::read(node["translateX"], translateX, translateX);
+    cv::read(node["translateY"], translateY, translateY);
+
+    std::vector<float> values;
+    cv::read(node["affine"], values, std::vector<float>());
+    if (values.size() == 6) std::copy(values.begin(), values.end(), affine);
+    cv::read(node["corners"], values, std::vector<float>());
+    if (values.size() == 8) std::copy(values.begin(), values.end(), corners);
+
+    cv::read(node["focal"], focal, focal);
+    cv::read(node["k1"], k1, k1);
+    cv::read(node["k2"], k2, k2);
+    cv::read(node["p1"], p1, p1);
+    cv::read(node["p2"], p2, p2);
+    cv::read(node["k3"], k3, k3);
+}
+
+void TransformNode::setInputs(const std::vector<cv::Mat>& input) {
+    if (!input.empty()) {
+        inputImage = input[0];
+    } else {
+        inputImage.release();
+    }
+}
+
+std::vector<double> TransformNode::mapKey(cv::Size size, double pixelScale) const {
+    std::vector<double> key { (double)size.width, (double)size.height, (double)mode, (double)interpolation, pixelScale };
+    switch (mode) {
+        case Mode::Similarity: key.insert(key.end(), { angle, scale, translateX, translateY }); break;
+        case Mode::Affine:     key.insert(key.end(), std::begin(affine), std::end(affine)); break;
+        case Mode::Perspective: key.insert(key.end(), std::begin(corners), std::end(corners)); break;
+        case Mode::Undistort:  key.insert(key.end(), { focal, k1, k2, p1, p2, k3 }); break;
+    }
+    return key;
+}
+
+// Maps source pixel coordinates to output pixel coordinates.
+cv::Matx33d TransformNode::forwardMatrix(cv::Size size, double pixelScale) const {
+    if (mode == Mode::Perspective) {
+        float w = (float)size.width, h = (float)size.height;
+        cv::Point2f from[4] = { { 0, 0 }, { w, 0 }, { w, h }, { 0, h } };
+        cv::Point2f to[4];
+        for (int i = 0; i < 4; ++i) {
+            to[i] = from[i] + cv::Point2f(corners[i * 2] * w, corners[i * 2 + 1] * h);
+        }
+        return cv::Matx33d(cv::getPerspectiveTransform(from, to));
+    }
+
+    cv::Matx23d m;
+    if (mode == Mode::Affine) {
+        m = cv::Matx23d(affine[0], affine[1], affine[2] * pixelScale, affine[3], affine[4], affine[5] * pixelScale);
+    } else {
+        cv::Point2f center(size.width * 0.5f, size.height * 0.5f);
+        m = cv::Matx23d(cv::getRotationMatrix2D(center, angle, scale));
+        m(0, 2) += translateX * pixelScale;
+        m(1, 2) += translateY * pixelScale;
+    }
+    return cv::Matx33d(m(0, 0), m(0, 1), m(0, 2), m(1, 0), m(1, 1), m(1, 2), 0, 0, 1);
+}
+
+void TransformNode::buildMaps(cv::Size size, double pixelScale, cv::Mat& map1, cv::Mat& map2) const {
+    cv::Mat mapX(size, CV_32FC1), mapY(size, CV_32FC1);
+
+    if (mode == Mode::Undistort) {
+        double f = focal * size.width;
+        cv::Matx33d camera(f, 0, (size.width - 1) * 0.5, 0, f, (size.height - 1) * 0.5, 0, 0, 1);
+        cv::Mat distortion = (cv::Mat_<double>(1, 5) << k1, k2, p1, p2, k3);
+        cv::initUndistortRectifyMap(camera, distortion, cv::noArray(), camera, size, CV_32FC1, mapX, mapY);
+    } else {
+        cv::Matx33d inverse = forwardMatrix(size, pixelScale).inv();
+        cv::parallel_for_(cv::Range(0, size.height), [&](const cv::Range& band) {
+            for (int y = band.start; y < band.end; ++y) {
+                float* mx = mapX.ptr<float>(y);
+                float* my = mapY.ptr<float>(y);
+                for (int x = 0; x < size.width; ++x) {
+                    double w = inverse(2, 0) * x + inverse(2, 1) * y + inverse(2, 2);
+                    w = w != 0 ? 1.0 / w : 0.0;
+                    mx[x] = (float)((inverse(0, 0) * x + inverse(0, 1) * y + inverse(0, 2)) * w);
+                    my[x] = (float)((inverse(1, 0) * x + inverse(1, 1) * y + inverse(1, 2)) * w);
+                }
+            }
+        });
+    }
+
+    // integer coordinates plus an index into remap's interpolation tables:
+    // about half the memory traffic of float maps and no per-pixel float math.
+    // Coordinates saturate to 16 bits, which only stays outside the image
+    // (and so in the border) while every pixel the filter reads fits too.
+    if (std::max(size.width, size.height) > SHRT_MAX - 4) {
+        map1 = mapX;
+        map2 = mapY;
+        return;
+    }
+    cv::convertMaps(mapX, mapY, map1, map2, CV_16SC2, interpolation == 0);
+}
+
+void TransformNode::apply(const cv::Mat& input, cv::Mat& output, double pixelScale) const {
+    if (input.empty()) {
+        output.release();
+        return;
+    }
+
+    cv::Size size = imageSize(input);
+    std::vector<double> key = mapKey(size, pixelScale);
+    cv::Mat map1, map2;
+    bool cached = false;
+    {
+        std::lock_guard<std::mutex> lock(mapsMutex);
+        auto it = std::find_if(maps.begin(), maps.end(), [&](const Maps& entry) { return entry.key == key; });
+        if (it != maps.end()) {
+            std::rotate(it, it + 1, maps.end());
+            map1 = maps.back().map1;
+            map2 = maps.back().map2;
+            cached = true;
+        }
+    }
+    if (!cached) {
+        // built without the lock, so contexts using other cached maps don't
+        // wait on it; two contexts missing at once both build, and one is kept
+        buildMaps(size, pixelScale, map1, map2);
+        std::lock_guard<std::mutex> lock(mapsMutex);
+        if (std::none_of(maps.begin(), maps.end(), [&](const Maps& entry) { return entry.key == key; })) {
+            if (maps.size() >= kCachedMaps) maps.erase(maps.begin());
+            maps.push_back({ std::move(key), map1, map2 });
+        }
+    }
+
+    static const int kInterpolation[] = { cv::INTER_NEAREST, cv::INTER_LINEAR, cv::INTER_CUBIC };
+    static const int kBorder[] = { cv::BORDER_CONSTANT, cv::BORDER_REPLICATE, cv::BORDER_REFLECT_101 };
+    int flags = kInterpolation[interpolation];
+
+    if (isPlanar(input)) {
+        createPlanar(output, size, imageChannels(input), input.depth());
+        for (int c = 0; c < imageChannels(input); ++c) {
+            cv::Mat dst = planeView(output, c);
+            cv::remap(planeView(input, c), dst, map1, map2, flags, kBorder[border]);
+        }
+    } else {
+        cv::remap(input, output, map1, map2, flags, kBorder[border]);
+    }
+}
+
+void TransformNode::process() {
+    // a proxy image is 1/proxyScale the size; shifts must shrink with it
+    apply(inputImage, outputImage, 1.0 / proxyScale);
+}
+
+void TransformNode::compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>&) const {
+    apply(inputs[0], outputs[0], 1.0);
+}
+
+cv::Mat TransformNode::getOutput(int) const {
+    return outputImage;
+}
+
+void TransformNode::preview() {
+    if (outputImage.empty()) {
+        ImGui::Text("No output");
+        return;
+    }
+
+    if (textureID) glDeleteTextures(1, &textureID);
+    textureID = matToTexture(outputImage);
+
+    if (textureID && glIsTexture(textureID)) {
+        ImGui::Text("Preview:");
+        ImGui::Image((ImTextureID)(intptr_t)textureID, ImVec2(128, 128), ImVec2(1, 0), ImVec2(0, 1));
+    }
+}
+
+void TransformNode::renderPropertiesUI() {
+    ImGui::Text("Transform");
+
+    bool updated = false;
+
+    int modeIndex = (int)mode;
+    if (ImGui::Combo("Mode", &modeIndex, kModeNames, IM_ARRAYSIZE(kModeNames))) {
+        mode = static_cast<Mode>(modeIndex);
+        updated = true;
+    }
+    updated |= ImGui::Combo("Interpolation", &interpolation, kInterpolationNames, IM_ARRAYSIZE(kInterpolationNames));
+    updated |= ImGui::Combo("Border", &border, kBorderNames, IM_ARRAYSIZE(kBorderNames));
+
+    switch (mode) {
+        case Mode::Similarity:
+            updated |= ImGui::SliderFloat("Angle", &angle, -180.0f, 180.0f);
+            updated |= ImGui::SliderFloat("Scale", &scale, 0.1f, 4.0f);
+            updated |= ImGui::InputFloat("Translate X", &translateX);
+            updated |= ImGui::InputFloat("Translate Y", &translateY);
+            break;
+        case Mode::Affine:
+            updated |= ImGui::InputFloat3("Row 1", &affine[0]);
+            updated |= ImGui::InputFloat3("Row 2", &affine[3]);
+            break;
+        case Mode::Perspective:
+            updated |= ImGui::SliderFloat2("Top Left", &corners[0], -0.5f, 0.5f);
+            updated |= ImGui::SliderFloat2("Top Right", &corners[2], -0.5f, 0.5f);
+            updated |= ImGui::SliderFloat2("Bottom Right", &corners[4], -0.5f, 0.5f);
+            updated |= ImGui::SliderFloat2("Bottom Left", &corners[6], -0.5f, 0.5f);
+            break;
+        case Mode::Undistort:
+            updated |= ImGui::SliderFloat("Focal (x width)", &focal, 0.2f, 3.0f);
+            updated |= ImGui::SliderFloat("k1", &k1, -1.0f, 1.0f);
+            updated |= ImGui::SliderFloat("k2", &k2, -1.0f, 1.0f);
+            updated |= ImGui::SliderFloat("p1", &p1, -0.1f, 0.1f);
+            updated |= ImGui::SliderFloat("p2", &p2, -0.1f, 0.1f);
+            updated |= ImGui::SliderFloat("k3", &k3, -1.0f, 1.0f);
+            break;
+    }
+
+    if (ImGui::Button("Reset")) {
+        angle = 0.0f;
+        scale = 1.0f;
+        translateX = translateY = 0.0f;
+        std::fill(std::begin(affine), std::end(affine), 0.0f);
+        affine[0] = affine[4] = 1.0f;
+        std::fill(std::begin(corners), std::end(corners), 0.0f);
+        focal = 1.0f;
+        k1 = k2 = p1 = p2 = k3 = 0.0f;
+        updated = true;
+    }
+
+    if (updated) {
+        markDirty();
+    }
+}
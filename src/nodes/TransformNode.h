@@ -0,0 +1,72 @@
+#pragma once
+#include "../core/Node.h"
+#include <opencv2/opencv.hpp>
+#include <GL/gl.h>
+#include <mutex>
+#include <vector>
+
+// Geometric warp of the image (same output size): rotate/scale/translate,
+// a general affine or perspective matrix, or lens undistortion. The source
+// coordinate of every output pixel is computed into a fixed-point remap
+// table only when the parameters or the input size change; each new image
+// (e.g. every frame of a sequence) is then just a cv::remap with that table.
+class TransformNode : public Node {
+public:
+    enum class Mode { Similarity, Affine, Perspective, Undistort };
+
+private:
+    cv::Mat inputImage, outputImage;
+    GLuint textureID = 0;
+
+    Mode mode = Mode::Similarity;
+    int interpolation = 1; // 0 nearest, 1 bilinear, 2 bicubic
+    int border = 0;        // 0 transparent, 1 replicate, 2 reflect
+
+    // Similarity: about the image centre, then shifted (full-resolution pixels)
+    float angle = 0.0f, scale = 1.0f, translateX = 0.0f, translateY = 0.0f;
+    // Affine: 2x3 forward matrix, row-major (full-resolution pixels)
+    float affine[6] = { 1, 0, 0, 0, 1, 0 };
+    // Perspective: where each corner moves (TL, TR, BR, BL), as a fraction of the image size
+    float corners[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    // Undistort: focal length as a fraction of the width, Brown-Conrady coefficients
+    float focal = 1.0f;
+    float k1 = 0.0f, k2 = 0.0f, p1 = 0.0f, p2 = 0.0f, k3 = 0.0f;
+
+    struct Maps {
+        std::vector<double> key; // parameters and size the maps were built for
+        cv::Mat map1, map2;      // CV_16SC2 integer coordinates, CV_16UC1 sub-pixel index
+                                 // (CV_32FC1 x and y past the 16-bit coordinate range)
+    };
+    // shared by execution contexts: compute() may run on many threads, and a
+    // batch may mix image sizes, so a few are kept, most recently used last
+    static constexpr size_t kCachedMaps = 4;
+    mutable std::mutex mapsMutex;
+    mutable std::vector<Maps> maps;
+
+    // pixelScale converts the pixel-valued parameters (translations) to the
+    // image's resolution: 1 / proxyScale for a proxy preview, 1 otherwise.
+    std::vector<double> mapKey(cv::Size size, double pixelScale) const;
+    cv::Matx33d forwardMatrix(cv::Size size, double pixelScale) const;
+    void buildMaps(cv::Size size, double pixelScale, cv::Mat& map1, cv::Mat& map2) const;
+    void apply(const cv::Mat& input, cv::Mat& output, double pixelScale) const;
+
+public:
+    TransformNode(int id, const std::string& name = "Transform");
+
+    void setInputs(const std::vector<cv::Mat>& input) override;
+    void process() override;
+    void compute(const std::vector<cv::Mat>& inputs, std::vector<cv::Mat>& outputs, const std::vector<bool>& requested) const override;
+    std::shared_ptr<Node> clone() const override;
+    const char* typeName() const override { return "Transform"; }
+    void writeParameters(cv::FileStorage& fs) const override;
+    void readParameters(const cv::FileNode& node) override;
+    cv::Mat getOutput(int port = 0) const override;
+    // a warp can move any source row anywhere
+    bool isStreamable() const override { return false; }
+    void preview() override;
+    void renderPropertiesUI() override;
+
+    ~TransformNode() override {
+        if (textureID) glDeleteTextures(1, &textureID);
+    }
+};
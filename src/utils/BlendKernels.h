@@ -0,0 +1,102 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cmath>
+#include <type_traits>
+#include "PixelKernels.h"
+
+enum class BlendMode { Normal, Multiply, Screen, Overlay, Add, Difference };
+
+// Separable blend term for premultiplied colour: as * ab * B(Cb, Cs) with
+// Cb = cb / ab and Cs = cs / as substituted and the divisions cancelled out,
+// so no mode needs to unpremultiply. All values are normalized to [0, 1].
+template <BlendMode M>
+inline float blendTerm(float cb, float ab, float cs, float as) {
+    if constexpr (M == BlendMode::Normal) {
+        return cs * ab;
+    } else if constexpr (M == BlendMode::Multiply) {
+        return cb * cs;
+    } else if constexpr (M == BlendMode::Screen) {
+        return cs * ab + cb * as - cb * cs;
+    } else if constexpr (M == BlendMode::Overlay) {
+        // a select, not a branch: both sides are cheap and it vectorizes
+        float low = 2.0f * cb * cs;
+        float high = ab * as - 2.0f * (ab - cb) * (as - cs);
+        return 2.0f * cb <= ab ? low : high;
+    } else if constexpr (M == BlendMode::Add) {
+        return std::min(cs * ab + cb * as, ab * as);
+    } else {
+        return std::fabs(cb * as - cs * ab);
+    }
+}
+
+// One row of "blend over base", source-over compositing with the blend term:
+//   co = cs (1 - ab) + cb (1 - as) + term,  ao = as + ab - as ab
+// Opacity and the mask scale the (premultiplied) blend pixel. Images without
+// alpha behave as opaque, which reduces this to lerp(cb, B(cb, cs), opacity).
+// STEP is the distance between a pixel's samples in one channel array: CN for
+// interleaved rows, 1 for planar ones. dst may alias base (in-place).
+template <typename T, int CN, BlendMode M, int STEP>
+void blendRow(const T* const* base, const T* const* blend, const T* mask, T* const* dst,
+              int cols, float opacity) {
+    constexpr bool hasAlpha = CN == 4;
+    constexpr int colourChannels = hasAlpha ? 3 : CN;
+    const float maxValue = PixelTraits<T>::maxValue;
+    const float inv = 1.0f / maxValue;
+
+    for (int x = 0; x < cols; ++x) {
+        const int i = x * STEP;
+        float k = mask ? opacity * (mask[x] * inv) : opacity;
+        float ab = hasAlpha ? base[CN - 1][i] * inv : 1.0f;
+        float as = hasAlpha ? blend[CN - 1][i] * inv * k : k;
+
+        for (int c = 0; c < colourChannels; ++c) {
+            float cb = base[c][i] * inv;
+            float cs = blend[c][i] * inv * k;
+            float co = cs * (1.0f - ab) + cb * (1.0f - as) + blendTerm<M>(cb, ab, cs, as);
+            dst[c][i] = clampPixel<T>(co * maxValue);
+        }
+        if constexpr (hasAlpha) {
+            dst[CN - 1][i] = clampPixel<T>((as + ab - as * ab) * maxValue);
+        }
+    }
+}
+
+// Blends `blend` over `base` into `dst` in a single pass. All three share
+// shape, depth and layout (interleaved or planar) and dst must already be
+// allocated; it may be base itself. `mask` is empty or a 2-D single-channel
+// image of the same size and depth.
+template <typename T, int CN>
+void blendKernel(const cv::Mat& base, const cv::Mat& blend, const cv::Mat& mask, cv::Mat& dst,
+                 BlendMode mode, float opacity) {
+    const bool planar = isPlanar(base);
+    const cv::Size size = imageSize(base);
+
+    auto run = [&](auto modeTag) {
+        constexpr BlendMode M = decltype(modeTag)::value;
+        const T* b[CN];
+        const T* s[CN];
+        T* d[CN];
+        for (int y = 0; y < size.height; ++y) {
+            for (int c = 0; c < CN; ++c) {
+                b[c] = planar ? base.ptr<T>(c, y) : base.ptr<T>(y) + c;
+                s[c] = planar ? blend.ptr<T>(c, y) : blend.ptr<T>(y) + c;
+                d[c] = planar ? dst.ptr<T>(c, y) : dst.ptr<T>(y) + c;
+            }
+            const T* m = mask.empty() ? nullptr : mask.ptr<T>(y);
+            if (planar) {
+                blendRow<T, CN, M, 1>(b, s, m, d, size.width, opacity);
+            } else {
+                blendRow<T, CN, M, CN>(b, s, m, d, size.width, opacity);
+            }
+        }
+    };
+
+    switch (mode) {
+        case BlendMode::Normal:     run(std::integral_constant<BlendMode, BlendMode::Normal>{}); break;
+        case BlendMode::Multiply:   run(std::integral_constant<BlendMode, BlendMode::Multiply>{}); break;
+        case BlendMode::Screen:     run(std::integral_constant<BlendMode, BlendMode::Screen>{}); break;
+        case BlendMode::Overlay:    run(std::integral_constant<BlendMode, BlendMode::Overlay>{}); break;
+        case BlendMode::Add:        run(std::integral_constant<BlendMode, BlendMode::Add>{}); break;
+        case BlendMode::Difference: run(std::integral_constant<BlendMode, BlendMode::Difference>{}); break;
+    }
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "PixelKernels.h"
+
+// sRGB transfer functions. Integer images look every value up in a table
+// built once per depth (256 or 65536 entries); float images use polynomial
+// fits of the curved segment, branch-free over a row so the loops vectorize.
+// Values above 1 (HDR) fall back to the exact power function.
+
+enum class Transfer { SrgbToLinear, LinearToSrgb };
+
+inline float srgbToLinearExact(float v) {
+    return v <= 0.04045f ? v / 12.92f : std::pow((v + 0.055f) / 1.055f, 2.4f);
+}
+
+inline float linearToSrgbExact(float v) {
+    return v <= 0.0031308f ? v * 12.92f : 1.055f * std::pow(v, 1.0f / 2.4f) - 0.055f;
+}
+
+// Degree-7 Chebyshev fit of ((v + 0.055) / 1.055)^2.4 on [0.04045, 1],
+// in u = (2v - 1.04045) / 0.95955. Max error 3e-6.
+inline float srgbToLinearPoly(float v) {
+    float u = (2.0f * std::min(v, 1.0f) - 1.04045f) * (1.0f / 0.95955f);
+    float p = 0.000296414684f;
+    p = p * u - 0.000618423859f;
+    p = p * u + 0.00090999715f;
+    p = p * u - 0.00361006637f;
+    p = p * u + 0.0303364154f;
+    p = p * u + 0.272553682f;
+    p = p * u + 0.466890633f;
+    p = p * u + 0.233242124f;
+    return v <= 0.04045f ? v * (1.0f / 12.92f) : p;
+}
+
+// Degree-6 fit of 1.055 * v^(1/2.4) - 0.055 on [0.0031308, 1], taken in
+// t = v^(1/4) (two square roots) where the curve is smooth: as t^(5/3).
+// Max error 2.2e-6.
+inline float linearToSrgbPoly(float v) {
+    constexpr float t0 = 0.236545f; // 0.0031308^(1/4)
+    float t = std::sqrt(std::sqrt(std::min(std::max(v, 0.0031308f), 1.0f)));
+    float u = (2.0f * t - (1.0f + t0)) * (1.0f / (1.0f - t0));
+    float p = 0.000191006067f;
+    p = p * u - 0.000528754026f;
+    p = p * u + 0.0013876973f;
+    p = p * u - 0.00681233266f;
+    p = p * u + 0.100255661f;
+    p = p * u + 0.487117618f;
+    p = p * u + 0.418389946f;
+    return v <= 0.0031308f ? v * 12.92f : p;
+}
+
+// Lookup table for an integer depth, built on first use (thread-safe).
+template <typename T>
+const std::vector<T>& transferTable(Transfer transfer) {
+    static_assert(std::is_integral_v<T>, "tables are for integer depths");
+    auto build = [](Transfer t) {
+        const float maxValue = PixelTraits<T>::maxValue;
+        std::vector<T> table((size_t)maxValue + 1);
+        for (size_t i = 0; i < table.size(); ++i) {
+            float v = i / maxValue;
+            float out = t == Transfer::SrgbToLinear ? srgbToLinearExact(v) : linearToSrgbExact(v);
+            table[i] = clampPixel<T>(out * maxValue);
+        }
+        return table;
+    };
+    static const std::vector<T> toLinear = build(Transfer::SrgbToLinear);
+    static const std::vector<T> toSrgb = build(Transfer::LinearToSrgb);
+    return transfer == Transfer::SrgbToLinear ? toLinear : toSrgb;
+}
+
+// n colour values without alpha, contiguous.
+template <typename T>
+void transferRow(const T* s, T* d, int n, Transfer transfer) {
+    if constexpr (std::is_same_v<T, float>) {
+        if (transfer == Transfer::SrgbToLinear) {
+            for (int i = 0; i < n; ++i) d[i] = srgbToLinearPoly(s[i]);
+            for (int i = 0; i < n; ++i) if (s[i] > 1.0f) d[i] = srgbToLinearExact(s[i]);
+        } else {
+            for (int i = 0; i < n; ++i) d[i] = linearToSrgbPoly(s[i]);
+            for (int i = 0; i < n; ++i) if (s[i] > 1.0f) d[i] = linearToSrgbExact(s[i]);
+        }
+    } else {
+        const T* table = transferTable<T>(transfer).data();
+        for (int i = 0; i < n; ++i) d[i] = table[s[i]];
+    }
+}
+
+// Premultiplied colour: the curve applies to the straight colour, so each
+// value is divided by alpha, mapped, and multiplied back. Opaque pixels
+// take the plain path. `stride` steps between a pixel's values.
+template <typename T>
+void transferRowPremultiplied(const T* s, T* d, const T* alpha, int n, int stride, Transfer transfer) {
+    const float maxValue = PixelTraits<T>::maxValue;
+    for (int i = 0; i < n; ++i) {
+        T a = alpha[i * stride];
+        T v = s[i * stride];
+        T out;
+        if (a == static_cast<T>(maxValue)) {
+            transferRow<T>(&v, &out, 1, transfer);
+        } else if (a > 0) {
+            float straight = std::min(v * maxValue / a, maxValue);
+            T level = clampPixel<T>(straight);
+            T mapped;
+            transferRow<T>(&level, &mapped, 1, transfer);
+            out = clampPixelTo<T>(mapped * (a / maxValue), a);
+        } else {
+            out = 0;
+        }
+        d[i * stride] = out;
+    }
+}
+
+template <typename T, int CN>
+void transferKernel(const cv::Mat& src, cv::Mat& dst, Transfer transfer) {
+    cv::Size size = imageSize(src);
+
+    if (isPlanar(src)) {
+        createPlanar(dst, size, CN, src.depth());
+        std::vector<cv::Mat> in = planeViews(src), out = planeViews(dst);
+        cv::parallel_for_(cv::Range(0, size.height), [&](const cv::Range& band) {
+            for (int y = band.start; y < band.end; ++y) {
+                for (int c = 0; c < std::min(CN, 3); ++c) {
+                    const T* s = in[c].ptr<T>(y);
+                    T* d = out[c].ptr<T>(y);
+                    if (CN == 4) transferRowPremultiplied<T>(s, d, in[3].ptr<T>(y), size.width, 1, transfer);
+                    else transferRow<T>(s, d, size.width, transfer);
+                }
+                if (CN == 4) {
+                    std::copy_n(in[3].ptr<T>(y), size.width, out[3].ptr<T>(y));
+                }
+            }
+        });
+        return;
+    }
+
+    dst.create(size, src.type());
+    cv::parallel_for_(cv::Range(0, size.height), [&](const cv::Range& band) {
+        for (int y = band.start; y < band.end; ++y) {
+            const T* s = src.ptr<T>(y);
+            T* d = dst.ptr<T>(y);
+            if constexpr (CN == 4) {
+                for (int c = 0; c < 3; ++c) {
+                    transferRowPremultiplied<T>(s + c, d + c, s + 3, size.width, 4, transfer);
+                }
+                for (int x = 0; x < size.width; ++x) d[x * 4 + 3] = s[x * 4 + 3];
+            } else {
+                // no alpha: the whole row is one run of values
+                transferRow<T>(s, d, size.width * CN, transfer);
+            }
+        }
+    });
+}
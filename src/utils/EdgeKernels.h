@@ -0,0 +1,103 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include "PixelKernels.h"
+
+// Fused edge kernels: grayscale conversion, the 3x3 X/Y derivatives, the
+// magnitude and the threshold all happen in one pass. Each band of rows keeps
+// a ring of three grayscale rows, so the only full-frame buffer is the output.
+
+enum class EdgeOperator { Sobel, Scharr };
+
+// BORDER_REFLECT_101, matching cv::Sobel's default.
+inline int reflect101(int i, int n) {
+    if (n == 1) return 0;
+    if (i < 0) return -i;
+    if (i >= n) return 2 * n - 2 - i;
+    return i;
+}
+
+// Calls emit(y, x, gx, gy) for every pixel, with the derivatives of the gray
+// image (scaled by grayScale) under a Sobel ([1 2 1] x [-1 0 1]) or Scharr
+// ([3 10 3] x [-1 0 1]) stencil. Rows are split into bands processed in
+// parallel; each band primes its own three-row ring.
+template <typename T, int CN, typename Emit>
+void gradientPass(const cv::Mat& src, EdgeOperator op, float grayScale, Emit&& emit) {
+    GrayRows<T, CN> gray(src, grayScale);
+    const int rows = gray.rows(), cols = gray.cols();
+    const float side = op == EdgeOperator::Sobel ? 1.0f : 3.0f;
+    const float mid = op == EdgeOperator::Sobel ? 2.0f : 10.0f;
+
+    cv::parallel_for_(cv::Range(0, rows), [&](const cv::Range& band) {
+        // padded by one column each side so the stencil needs no branches
+        std::vector<float> storage(3 * (cols + 2));
+        float* ring[3] = { &storage[1], &storage[cols + 3], &storage[2 * cols + 5] };
+        int ringRow[3] = { -1, -1, -1 };
+
+        auto rowAt = [&](int y) -> const float* {
+            int src = reflect101(y, rows);
+            int slot = ((y % 3) + 3) % 3;
+            if (ringRow[slot] != src) {
+                gray.read(src, ring[slot]);
+                ring[slot][-1] = ring[slot][reflect101(-1, cols)];
+                ring[slot][cols] = ring[slot][reflect101(cols, cols)];
+                ringRow[slot] = src;
+            }
+            return ring[slot];
+        };
+
+        for (int y = band.start; y < band.end; ++y) {
+            const float* above = rowAt(y - 1);
+            const float* here = rowAt(y);
+            const float* below = rowAt(y + 1);
+            for (int x = 0; x < cols; ++x) {
+                float gx = side * (above[x + 1] - above[x - 1]) + mid * (here[x + 1] - here[x - 1]) +
+                           side * (below[x + 1] - below[x - 1]);
+                float gy = side * (below[x - 1] - above[x - 1]) + mid * (below[x] - above[x]) +
+                           side * (below[x + 1] - above[x + 1]);
+                emit(y, x, gx, gy);
+            }
+        }
+    });
+}
+
+// Gradient magnitude into a one-channel dst of depth T, normalized so a full
+// step edge maps to the maximum value. With threshold >= 0 the output is
+// binary instead: max where the normalized magnitude reaches threshold (0..1).
+template <typename T, int CN>
+void edgeMagnitudeKernel(const cv::Mat& src, cv::Mat& dst, EdgeOperator op, float threshold) {
+    cv::Mat out = createSingleChannel(src, dst);
+
+    const float maxValue = PixelTraits<T>::maxValue;
+    const float norm = 1.0f / (op == EdgeOperator::Sobel ? 4.0f : 16.0f);
+    const bool binary = threshold >= 0.0f;
+    // compare squared magnitudes: no sqrt in the binary case
+    const float limit = threshold * maxValue / norm;
+    const float limitSq = limit * limit;
+
+    gradientPass<T, CN>(src, op, 1.0f, [&](int y, int x, float gx, float gy) {
+        float sq = gx * gx + gy * gy;
+        T* d = out.ptr<T>(y);
+        if (binary) {
+            d[x] = sq >= limitSq ? static_cast<T>(maxValue) : T(0);
+        } else {
+            d[x] = clampPixel<T>(std::sqrt(sq) * norm);
+        }
+    });
+}
+
+// 16-bit signed derivatives for cv::Canny's (dx, dy) overload. The gray image
+// is brought to the 0..255 range first, so Canny thresholds mean the same
+// thing at every working depth and Scharr responses still fit in 16 bits.
+template <typename T, int CN>
+void edgeDerivativesKernel(const cv::Mat& src, cv::Mat& dx, cv::Mat& dy, EdgeOperator op) {
+    cv::Size size = imageSize(src);
+    dx.create(size, CV_16SC1);
+    dy.create(size, CV_16SC1);
+    gradientPass<T, CN>(src, op, 255.0f / PixelTraits<T>::maxValue, [&](int y, int x, float gx, float gy) {
+        dx.ptr<int16_t>(y)[x] = cv::saturate_cast<int16_t>(gx);
+        dy.ptr<int16_t>(y)[x] = cv::saturate_cast<int16_t>(gy);
+    });
+}
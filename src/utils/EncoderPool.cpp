@@ -0,0 +1,105 @@
+#include "EncoderPool.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include "../core/ImageFormat.h"
+#include "PixelKernels.h"
+#include "RawImage.h"
+
+cv::Mat prepareForEncoding(const cv::Mat& image, const std::string& format) {
+    cv::Mat encoded = toInterleaved(image).clone();
+
+    // graph images are premultiplied; files store straight alpha
+    if (encoded.channels() == 4) {
+        dispatchPixelType(encoded.depth(), 1, [&](auto pixel) {
+            unpremultiplyKernel<typename decltype(pixel)::Type>(encoded);
+        });
+    }
+
+    // JPG/BMP are 8-bit only, PNG tops out at 16-bit, TIFF takes anything
+    if ((format == "JPG" || format == "BMP") && encoded.depth() != CV_8U) {
+        convertDepth(encoded, encoded, CV_8U);
+    } else if (format == "PNG" && encoded.depth() != CV_8U && encoded.depth() != CV_16U) {
+        convertDepth(encoded, encoded, CV_16U);
+    }
+    if ((format == "JPG" || format == "BMP") && encoded.channels() == 4) {
+        cv::cvtColor(encoded, encoded, cv::COLOR_BGRA2BGR);
+    }
+    return encoded;
+}
+
+EncoderPool::EncoderPool(int threads, size_t maxPending) : queue(maxPending) {
+    if (threads <= 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (int i = 0; i < threads; ++i) {
+        workers.emplace_back(&EncoderPool::workerLoop, this);
+    }
+}
+
+EncoderPool::~EncoderPool() {
+    // finish what was queued, then stop
+    queue.close();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+EncoderPool& EncoderPool::shared() {
+    static EncoderPool pool;
+    return pool;
+}
+
+void EncoderPool::submit(Job job, Callback onDone) {
+    ++pending;
+    if (!queue.push(Task { std::move(job), std::move(onDone) })) {
+        --pending;
+    }
+}
+
+void EncoderPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(idleMutex);
+    idle.wait(lock, [&] { return pending == 0; });
+}
+
+EncoderPool::Result EncoderPool::encode(const Job& job) {
+    auto start = std::chrono::steady_clock::now();
+
+    Result result;
+    result.path = job.path;
+    try {
+        if (job.format == "RAW") {
+            // intermediates keep the graph's own representation
+            result.ok = writeRawImage(job.path, job.image);
+        } else {
+            result.ok = cv::imwrite(job.path, prepareForEncoding(job.image, job.format), job.params);
+        }
+    } catch (const cv::Exception& e) {
+        std::cerr << "Encoder error: " << e.what() << "\n";
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (!result.ok) {
+        std::cerr << "Failed to save " << result.path << "\n";
+    }
+    return result;
+}
+
+void EncoderPool::workerLoop() {
+    Task task;
+    while (queue.pop(task)) {
+        Result result = encode(task.job);
+        if (!result.ok) {
+            ++failed;
+        }
+        ++completed;
+        if (task.onDone) task.onDone(result);
+
+        task = Task();
+        {
+            std::lock_guard<std::mutex> lock(idleMutex);
+            --pending;
+        }
+        idle.notify_all();
+    }
+}
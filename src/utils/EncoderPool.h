@@ -0,0 +1,76 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../core/BoundedQueue.h"
+
+// Straight-alpha copy of a graph image in a depth/channel layout the given
+// format ("JPG", "PNG", "BMP", "TIFF") can store. "RAW" jobs skip this and
+// are written verbatim with writeRawImage().
+cv::Mat prepareForEncoding(const cv::Mat& image, const std::string& format);
+
+// Background pool of image encoders. Each job runs prepareForEncoding() and
+// cv::imwrite() on a worker thread, so saving never blocks the caller beyond
+// handing over the Mat. Codecs like PNG compress on a single thread, so the
+// pool's parallelism comes from encoding several files at once.
+class EncoderPool {
+public:
+    struct Job {
+        std::string path;
+        std::string format;
+        std::vector<int> params;
+        cv::Mat image;
+    };
+
+    struct Result {
+        std::string path;
+        bool ok = false;
+        double seconds = 0.0;
+    };
+
+    // Runs on the encoder thread once the file is written (or failed).
+    using Callback = std::function<void(const Result&)>;
+
+    // maxPending bounds queued jobs: submit() blocks while that many wait.
+    explicit EncoderPool(int threads = 0, size_t maxPending = 64);
+    ~EncoderPool();
+
+    EncoderPool(const EncoderPool&) = delete;
+    EncoderPool& operator=(const EncoderPool&) = delete;
+
+    // Pool used by interactive saves.
+    static EncoderPool& shared();
+
+    // Encodes a job on the calling thread (what each pool worker runs).
+    static Result encode(const Job& job);
+
+    void submit(Job job, Callback onDone = nullptr);
+    // Blocks until every submitted job has finished.
+    void waitIdle();
+
+    int getThreadCount() const { return (int)workers.size(); }
+    int getPendingCount() const { return pending; }
+    int getCompletedCount() const { return completed; }
+    int getFailedCount() const { return failed; }
+
+private:
+    struct Task {
+        Job job;
+        Callback onDone;
+    };
+
+    BoundedQueue<Task> queue;
+    std::vector<std::thread> workers;
+    std::atomic<int> pending{0};
+    std::atomic<int> completed{0};
+    std::atomic<int> failed{0};
+    std::mutex idleMutex;
+    std::condition_variable idle;
+
+    void workerLoop();
+};
@@ -0,0 +1,92 @@
+#include "FileWatcher.h"
+#include <filesystem>
+#include <iostream>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+FileWatcher& FileWatcher::shared() {
+    static FileWatcher watcher;
+    return watcher;
+}
+
+FileWatcher::FileWatcher() {
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotifyFd < 0 || wakeFd < 0) {
+        std::cerr << "File watching unavailable" << std::endl;
+        return;
+    }
+    thread = std::thread(&FileWatcher::run, this);
+}
+
+FileWatcher::~FileWatcher() {
+    if (thread.joinable()) {
+        uint64_t one = 1;
+        (void)!write(wakeFd, &one, sizeof(one));
+        thread.join();
+    }
+    if (inotifyFd >= 0) close(inotifyFd);
+    if (wakeFd >= 0) close(wakeFd);
+}
+
+int FileWatcher::watch(const std::string& path, Callback onChange) {
+    if (inotifyFd < 0 || path.empty()) return 0;
+
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::path absolute = fs::absolute(path, ec);
+    if (ec) return 0;
+
+    std::string dir = absolute.parent_path().string();
+    // the same directory always maps to the same watch descriptor
+    int wd = inotify_add_watch(inotifyFd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd < 0) return 0;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    int id = nextSubscription++;
+    subscriptions[id] = Subscription { wd, absolute.filename().string(), std::move(onChange) };
+    ++watchUsers[wd];
+    return id;
+}
+
+void FileWatcher::unwatch(int subscription) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = subscriptions.find(subscription);
+    if (it == subscriptions.end()) return;
+
+    int wd = it->second.wd;
+    subscriptions.erase(it);
+    if (--watchUsers[wd] == 0) {
+        watchUsers.erase(wd);
+        inotify_rm_watch(inotifyFd, wd);
+    }
+}
+
+void FileWatcher::run() {
+    alignas(struct inotify_event) char buffer[16 * 1024];
+    pollfd fds[2] = { { inotifyFd, POLLIN, 0 }, { wakeFd, POLLIN, 0 } };
+
+    while (true) {
+        if (poll(fds, 2, -1) < 0) continue;
+        if (fds[1].revents & POLLIN) return;
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        ssize_t length;
+        while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (char* p = buffer; p < buffer + length;) {
+                auto* event = reinterpret_cast<inotify_event*>(p);
+                p += sizeof(inotify_event) + event->len;
+                if (event->len == 0) continue;
+
+                for (const auto& [id, sub] : subscriptions) {
+                    if (sub.wd == event->wd && sub.filename == event->name && sub.onChange) {
+                        sub.onChange();
+                    }
+                }
+            }
+        }
+    }
+}
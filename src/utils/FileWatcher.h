@@ -0,0 +1,45 @@
+#pragma once
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+// inotify-based file change notifications. Watches the parent directory of
+// each file (tools commonly save via write-to-temp + rename, which replaces
+// the inode a file watch would be on) and reports completed writes and
+// renames onto the watched name. Callbacks run on the watcher thread and
+// should only flag work for later, not do it.
+class FileWatcher {
+public:
+    using Callback = std::function<void()>;
+
+    static FileWatcher& shared();
+
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Returns a subscription id (> 0), or 0 if the path cannot be watched.
+    int watch(const std::string& path, Callback onChange);
+    void unwatch(int subscription);
+
+private:
+    struct Subscription {
+        int wd;
+        std::string filename;
+        Callback onChange;
+    };
+
+    int inotifyFd = -1;
+    int wakeFd = -1; // eventfd used to stop the thread
+    std::thread thread;
+    std::mutex mutex;
+    std::unordered_map<int, Subscription> subscriptions;
+    std::unordered_map<int, int> watchUsers; // wd -> subscriptions using it
+    int nextSubscription = 1;
+
+    FileWatcher();
+    void run();
+};
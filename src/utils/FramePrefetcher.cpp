@@ -0,0 +1,201 @@
+#include "FramePrefetcher.h"
+#include <algorithm>
+#include <climits>
+#include <filesystem>
+#include <iostream>
+#include <regex>
+
+FramePrefetcher::FramePrefetcher(const std::string& source, int capacity, int threads, PrepareFn prepare)
+    : prepare(std::move(prepare)), slots(std::max(capacity, 1)) {
+    std::string file = std::filesystem::path(source).filename().string();
+    bool isPattern = file.find('%') != std::string::npos || file.find('#') != std::string::npos;
+
+    if (isPattern) {
+        discoverSequence(source);
+    } else {
+        isVideo = true;
+        if (capture.open(source)) {
+            frameCount = (int)capture.get(cv::CAP_PROP_FRAME_COUNT);
+        }
+        threads = 1; // a video stream can only be decoded in order
+    }
+
+    if (frameCount <= 0) {
+        std::cerr << "No frames found for sequence: " << source << std::endl;
+        return;
+    }
+
+    for (int i = 0; i < std::max(threads, 1); ++i) {
+        workers.emplace_back(&FramePrefetcher::workerLoop, this);
+    }
+}
+
+FramePrefetcher::~FramePrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    frameReady.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void FramePrefetcher::discoverSequence(const std::string& source) {
+    namespace fs = std::filesystem;
+
+    fs::path sourcePath(source);
+    fs::path dir = sourcePath.has_parent_path() ? sourcePath.parent_path() : fs::path(".");
+    std::string file = sourcePath.filename().string();
+
+    // exactly one "%d" / "%0Nd" or run of '#' in the file name, and no other
+    // '%' or '#': anything else is not a sequence this can number
+    static const std::regex placeholder(R"(^([^%#]*)(?:%(0[1-9])?d|(#+))([^%#]*)$)");
+    std::smatch parts;
+    if (!std::regex_match(file, parts, placeholder)) {
+        std::cerr << "Sequence pattern needs exactly one %0Nd or #### in the file name: " << source << std::endl;
+        return;
+    }
+    frameDigits = parts[3].matched ? (int)parts[3].length() : parts[2].matched ? std::stoi(parts[2].str()) : 0;
+    if (frameDigits > 9) {
+        std::cerr << "Sequence pattern pads frame numbers to more than 9 digits: " << source << std::endl;
+        return;
+    }
+    framePrefix = (dir / parts[1].str()).string();
+    frameSuffix = parts[4].str();
+
+    // build a regex out of the literal prefix/suffix around the number; at
+    // most 9 digits, so every match fits an int
+    auto escape = [](const std::string& text) {
+        static const std::regex special(R"([.^$|()\[\]{}*+?\\])");
+        return std::regex_replace(text, special, R"(\$&)");
+    };
+    std::regex match("^" + escape(parts[1].str()) + "(\\d{1,9})" + escape(frameSuffix) + "$");
+
+    int lo = INT_MAX, hi = INT_MIN;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        std::smatch m;
+        std::string name = entry.path().filename().string();
+        if (std::regex_match(name, m, match)) {
+            int frame = std::stoi(m[1].str());
+            // "0012" isn't frame 12 of "%d", nor "12" of "%04d"
+            if (frameNumber(frame) != m[1].str()) continue;
+            lo = std::min(lo, frame);
+            hi = std::max(hi, frame);
+        }
+    }
+
+    if (lo <= hi) {
+        firstFrame = lo;
+        frameCount = hi - lo + 1;
+    }
+}
+
+std::string FramePrefetcher::frameNumber(int frame) const {
+    std::string number = std::to_string(frame);
+    if ((int)number.size() < frameDigits) number.insert(0, frameDigits - number.size(), '0');
+    return number;
+}
+
+std::string FramePrefetcher::framePath(int frame) const {
+    return framePrefix + frameNumber(frame) + frameSuffix;
+}
+
+bool FramePrefetcher::inWindowLocked(int index) const {
+    return index >= windowStart && index < windowStart + (int)slots.size() && index < frameCount;
+}
+
+void FramePrefetcher::seekLocked(int index) {
+    if (index == windowStart) return;
+
+    if (!inWindowLocked(index)) {
+        // jumping outside the window: everything buffered is useless
+        ++generation;
+        nextToDecode = index;
+        for (auto& slot : slots) {
+            slot = Slot();
+        }
+    }
+    windowStart = index;
+    nextToDecode = std::max(nextToDecode, index);
+    workAvailable.notify_all();
+}
+
+cv::Mat FramePrefetcher::getFrame(int index) {
+    if (index < 0 || index >= frameCount) return cv::Mat();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    seekLocked(index);
+
+    Slot& slot = slots[index % slots.size()];
+    frameReady.wait(lock, [&] { return stopping || (slot.ready && slot.frame == index); });
+    return slot.image;
+}
+
+bool FramePrefetcher::tryGetFrame(int index, cv::Mat& out) {
+    if (index < 0 || index >= frameCount) return false;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    seekLocked(index);
+
+    const Slot& slot = slots[index % slots.size()];
+    if (!slot.ready || slot.frame != index) return false;
+    out = slot.image;
+    return true;
+}
+
+int FramePrefetcher::bufferedCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    int count = 0;
+    for (const auto& slot : slots) {
+        if (slot.ready && slot.frame >= windowStart) ++count;
+    }
+    return count;
+}
+
+cv::Mat FramePrefetcher::decode(int index) {
+    cv::Mat frame;
+
+    if (isVideo) {
+        if (index != lastDecoded + 1) {
+            capture.set(cv::CAP_PROP_POS_FRAMES, index);
+        }
+        capture.read(frame);
+        lastDecoded = index;
+    } else {
+        frame = cv::imread(framePath(firstFrame + index), cv::IMREAD_UNCHANGED);
+    }
+
+    if (frame.empty()) {
+        std::cerr << "Failed to decode frame " << index << std::endl;
+        return frame;
+    }
+    return prepare ? prepare(frame) : frame;
+}
+
+void FramePrefetcher::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        workAvailable.wait(lock, [&] { return stopping || inWindowLocked(nextToDecode); });
+        if (stopping) return;
+
+        int index = nextToDecode++;
+        int claimedGeneration = generation;
+        Slot& slot = slots[index % slots.size()];
+        slot = Slot();
+        slot.frame = index;
+
+        lock.unlock();
+        cv::Mat image = decode(index);
+        lock.lock();
+
+        // the consumer may have seeked elsewhere while we were decoding
+        if (claimedGeneration != generation || slot.frame != index) continue;
+        slot.image = image;
+        slot.ready = true;
+        frameReady.notify_all();
+    }
+}
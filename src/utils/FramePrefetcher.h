@@ -0,0 +1,86 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Decodes frames of an image sequence or a video file ahead of the consumer
+// on background threads and keeps them in a fixed-size ring buffer.
+//
+// Sources:
+//   - numbered image sequences: "shot_%04d.png" or "shot_####.png" (exactly
+//     one number placeholder in the file name); the frame range is
+//     discovered from the files on disk
+//   - anything else is opened with cv::VideoCapture (container files)
+//
+// Image sequences decode on `threads` workers in parallel. Video streams are
+// inherently sequential, so they use a single decoder thread regardless.
+class FramePrefetcher {
+public:
+    // Runs on the decoder threads after each decode (format conversion etc).
+    using PrepareFn = std::function<cv::Mat(cv::Mat)>;
+
+    FramePrefetcher(const std::string& source, int capacity, int threads, PrepareFn prepare);
+    ~FramePrefetcher();
+
+    FramePrefetcher(const FramePrefetcher&) = delete;
+    FramePrefetcher& operator=(const FramePrefetcher&) = delete;
+
+    bool isOpen() const { return frameCount > 0; }
+    int getFrameCount() const { return frameCount; }
+    int getFirstFrame() const { return firstFrame; }
+    int getCapacity() const { return (int)slots.size(); }
+
+    // Blocks until frame `index` (0-based within the sequence) is decoded.
+    // Frames before `index` are dropped from the buffer and the decode window
+    // moves forward to start at it. Returns an empty Mat if decoding failed.
+    cv::Mat getFrame(int index);
+
+    // Non-blocking variant: returns false if the frame is not decoded yet
+    // (and moves the decode window there so it will be soon).
+    bool tryGetFrame(int index, cv::Mat& out);
+
+    // Number of frames currently decoded and waiting in the buffer.
+    int bufferedCount() const;
+
+private:
+    struct Slot {
+        int frame = -1;
+        bool ready = false;
+        cv::Mat image;
+    };
+
+    // frame paths are prefix + number zero-padded to digits + suffix; the
+    // user's text is never used as a printf format
+    std::string framePrefix, frameSuffix;
+    int frameDigits = 0;
+    bool isVideo = false;
+    int firstFrame = 0;
+    int frameCount = 0;
+    PrepareFn prepare;
+
+    mutable std::mutex mutex;
+    std::condition_variable frameReady;
+    std::condition_variable workAvailable;
+    std::vector<Slot> slots;
+    std::vector<std::thread> workers;
+    int windowStart = 0;   // oldest frame the consumer still wants
+    int nextToDecode = 0;  // next frame a worker will claim
+    int generation = 0;    // bumped on seeks so stale decodes are discarded
+    bool stopping = false;
+
+    // video decoder state, only touched by the single video worker
+    cv::VideoCapture capture;
+    int lastDecoded = -1;
+
+    void discoverSequence(const std::string& source);
+    std::string frameNumber(int frame) const;
+    std::string framePath(int frame) const;
+    void seekLocked(int index);
+    bool inWindowLocked(int index) const;
+    cv::Mat decode(int index);
+    void workerLoop();
+};
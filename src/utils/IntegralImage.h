@@ -0,0 +1,164 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include "PixelKernels.h"
+
+// Summed-area table of an image: one (rows + 1) x (cols + 1) CV_64F plane per
+// channel, or a single plane of its luminance for consumers that only look
+// at gray (half to a quarter of the memory: about 0.8 GB at 100 MP instead
+// of 3.2 GB for BGRA). Doubles keep sums of 100 MP 16-bit frames exact. Rows
+// are read straight from the source, interleaved or planar; no channel copies.
+struct IntegralImage {
+    std::vector<cv::Mat> planes;
+    cv::Size size; // of the source image
+
+    bool empty() const { return planes.empty(); }
+    int channels() const { return (int)planes.size(); }
+
+    // Sum of plane c over [x0, x1) x [y0, y1), clipped to the image.
+    double boxSum(int c, int x0, int y0, int x1, int y1) const {
+        x0 = std::max(x0, 0); y0 = std::max(y0, 0);
+        x1 = std::min(x1, size.width); y1 = std::min(y1, size.height);
+        const double* top = planes[c].ptr<double>(y0);
+        const double* bottom = planes[c].ptr<double>(y1);
+        return bottom[x1] - bottom[x0] - top[x1] + top[x0];
+    }
+
+    // One plane per channel.
+    static IntegralImage compute(const cv::Mat& src) {
+        IntegralImage result;
+        result.size = imageSize(src);
+        if (src.empty()) return result;
+
+        if (isPlanar(src) || src.channels() == 1) {
+            std::vector<cv::Mat> channels = isPlanar(src) ? planeViews(src) : std::vector<cv::Mat>{ src };
+            result.planes.resize(channels.size());
+            cv::parallel_for_(cv::Range(0, (int)channels.size()), [&](const cv::Range& range) {
+                for (int c = range.start; c < range.end; ++c) {
+                    cv::integral(channels[c], result.planes[c], CV_64F);
+                }
+            });
+            return result;
+        }
+
+        bool handled = dispatchPixelType(src.depth(), src.channels(), [&](auto pixel) {
+            using P = decltype(pixel);
+            result.planes = allocate(result.size, P::channels);
+            rowSums(result, [&](int y, int c, float* out) {
+                const typename P::Type* s = src.ptr<typename P::Type>(y) + c;
+                for (int x = 0; x < result.size.width; ++x) out[x] = (float)s[x * P::channels];
+            });
+        });
+        if (!handled) {
+            std::vector<cv::Mat> channels;
+            cv::split(src, channels);
+            result.planes.resize(channels.size());
+            for (size_t c = 0; c < channels.size(); ++c) cv::integral(channels[c], result.planes[c], CV_64F);
+        }
+        return result;
+    }
+
+    // One plane of the luminance, with GrayRows' weights (alpha ignored).
+    static IntegralImage computeGray(const cv::Mat& src) {
+        IntegralImage result;
+        result.size = imageSize(src);
+        if (src.empty()) return result;
+
+        dispatchPixelType(src.depth(), imageChannels(src), [&](auto pixel) {
+            using P = decltype(pixel);
+            GrayRows<typename P::Type, P::channels> gray(src, 1.0f);
+            result.planes = allocate(result.size, 1);
+            rowSums(result, [&](int y, int, float* out) { gray.read(y, out); });
+        });
+        return result;
+    }
+
+private:
+    static std::vector<cv::Mat> allocate(cv::Size size, int count) {
+        std::vector<cv::Mat> planes(count);
+        for (auto& plane : planes) {
+            plane.create(size.height + 1, size.width + 1, CV_64F);
+            plane.row(0).setTo(0.0);
+        }
+        return planes;
+    }
+
+    // Two passes over the tables: prefix sums along every row (rows in
+    // parallel, each produced by read(y, plane, values)), then running sums
+    // down the columns (column blocks in parallel).
+    template <typename Read>
+    static void rowSums(IntegralImage& result, Read&& read) {
+        const int rows = result.size.height, cols = result.size.width;
+        cv::parallel_for_(cv::Range(0, rows), [&](const cv::Range& band) {
+            std::vector<float> values(cols);
+            for (int y = band.start; y < band.end; ++y) {
+                for (int c = 0; c < result.channels(); ++c) {
+                    read(y, c, values.data());
+                    double* t = result.planes[c].ptr<double>(y + 1);
+                    double sum = 0;
+                    t[0] = 0;
+                    for (int x = 0; x < cols; ++x) {
+                        sum += values[x];
+                        t[x + 1] = sum;
+                    }
+                }
+            }
+        });
+
+        constexpr int kBlock = 256;
+        const int blocks = (cols + 1 + kBlock - 1) / kBlock;
+        cv::parallel_for_(cv::Range(0, blocks * result.channels()), [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; ++i) {
+                cv::Mat& plane = result.planes[i / blocks];
+                int x0 = (i % blocks) * kBlock, x1 = std::min(x0 + kBlock, cols + 1);
+                for (int y = 2; y <= rows; ++y) {
+                    const double* above = plane.ptr<double>(y - 1);
+                    double* t = plane.ptr<double>(y);
+                    for (int x = x0; x < x1; ++x) t[x] += above[x];
+                }
+            }
+        });
+    }
+};
+
+// Box mean over a (2 * rx + 1) x (2 * ry + 1) window, clipped at the image
+// edges, for every channel of the image `sums` was built from. dst gets that
+// image's size, CN channels of depth T, interleaved or planar.
+template <typename T, int CN>
+void boxFilterKernel(const IntegralImage& sums, cv::Mat& dst, int rx, int ry, bool planar) {
+    const int rows = sums.size.height, cols = sums.size.width;
+    const int depth = PixelTraits<T>::depth;
+    std::array<cv::Mat, CN> outPlanes;
+    if (planar) {
+        createPlanar(dst, sums.size, CN, depth);
+        for (int c = 0; c < CN; ++c) outPlanes[c] = planeView(dst, c);
+    } else {
+        dst.create(sums.size, CV_MAKETYPE(depth, CN));
+    }
+
+    cv::parallel_for_(cv::Range(0, rows), [&](const cv::Range& band) {
+        for (int y = band.start; y < band.end; ++y) {
+            int y0 = std::max(y - ry, 0), y1 = std::min(y + ry + 1, rows);
+            const double* top[CN];
+            const double* bottom[CN];
+            T* out[CN];
+            for (int c = 0; c < CN; ++c) {
+                top[c] = sums.planes[c].ptr<double>(y0);
+                bottom[c] = sums.planes[c].ptr<double>(y1);
+                out[c] = planar ? outPlanes[c].template ptr<T>(y) : dst.ptr<T>(y) + c;
+            }
+            const int stride = planar ? 1 : CN;
+
+            for (int x = 0; x < cols; ++x) {
+                int x0 = std::max(x - rx, 0), x1 = std::min(x + rx + 1, cols);
+                double inv = 1.0 / ((x1 - x0) * (y1 - y0));
+                for (int c = 0; c < CN; ++c) {
+                    double sum = bottom[c][x1] - bottom[c][x0] - top[c][x1] + top[c][x0];
+                    out[c][x * stride] = clampPixel<T>((float)(sum * inv));
+                }
+            }
+        }
+    });
+}
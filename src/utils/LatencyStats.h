@@ -0,0 +1,59 @@
+#pragma once
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Thread-safe request latency bookkeeping: totals per stage plus a window of
+// the most recent request latencies for percentiles.
+class LatencyStats {
+public:
+    struct Sample {
+        double decode = 0.0;   // seconds
+        double evaluate = 0.0;
+        double encode = 0.0;
+        double total = 0.0;
+    };
+
+    explicit LatencyStats(size_t window = 4096) : recent(window) {}
+
+    void record(const Sample& sample) {
+        std::lock_guard<std::mutex> lock(mutex);
+        recent[count % recent.size()] = sample.total;
+        ++count;
+        sum.decode += sample.decode;
+        sum.evaluate += sample.evaluate;
+        sum.encode += sample.encode;
+        sum.total += sample.total;
+    }
+
+    void recordError() {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++errors;
+    }
+
+    // One line: count, errors, mean stage times and p50/p95/p99 in ms.
+    std::string report() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (count == 0) return "requests=0 errors=" + std::to_string(errors);
+
+        std::vector<double> window(recent.begin(), recent.begin() + std::min(count, recent.size()));
+        std::sort(window.begin(), window.end());
+        auto percentile = [&](double p) { return window[std::min(window.size() - 1, (size_t)(p * window.size()))] * 1e3; };
+
+        char line[256];
+        std::snprintf(line, sizeof(line),
+            "requests=%zu errors=%zu mean_ms=%.2f (decode %.2f, evaluate %.2f, encode %.2f) p50=%.2f p95=%.2f p99=%.2f",
+            count, errors, sum.total / count * 1e3, sum.decode / count * 1e3, sum.evaluate / count * 1e3,
+            sum.encode / count * 1e3, percentile(0.50), percentile(0.95), percentile(0.99));
+        return line;
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::vector<double> recent;
+    size_t count = 0;
+    size_t errors = 0;
+    Sample sum;
+};
@@ -0,0 +1,277 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include "../core/ImageLayout.h"
+
+// Compile-time specialized pixel kernels. Callers resolve the (depth, channels)
+// pair once per evaluation with dispatchPixelType(); the kernels themselves
+// are templated on the element type and channel count so inner loops have
+// constant trip counts the compiler can unroll and vectorize.
+
+template <typename T> struct PixelTraits;
+
+template <> struct PixelTraits<uint8_t> {
+    static constexpr int depth = CV_8U;
+    static constexpr float maxValue = 255.0f;
+};
+
+template <> struct PixelTraits<uint16_t> {
+    static constexpr int depth = CV_16U;
+    static constexpr float maxValue = 65535.0f;
+};
+
+template <> struct PixelTraits<float> {
+    static constexpr int depth = CV_32F;
+    static constexpr float maxValue = 1.0f;
+};
+
+// Branch-free clamp + round that vectorizes, unlike cv::saturate_cast's lrint.
+template <typename T>
+inline T clampPixel(float v) {
+    return static_cast<T>(std::min(std::max(v + 0.5f, 0.0f), PixelTraits<T>::maxValue));
+}
+
+// Float is the HDR working format: values outside [0, 1] are kept, not clamped.
+template <>
+inline float clampPixel<float>(float v) { return v; }
+
+// Same as clampPixel but with an explicit upper bound (e.g. a pixel's alpha).
+template <typename T>
+inline T clampPixelTo(float v, float hi) {
+    return static_cast<T>(std::min(std::max(v + 0.5f, 0.0f), hi));
+}
+
+template <>
+inline float clampPixelTo<float>(float v, float hi) { return std::min(std::max(v, 0.0f), hi); }
+
+template <typename T, int CN>
+struct PixelType {
+    using Type = T;
+    static constexpr int channels = CN;
+};
+
+template <typename T, typename Fn>
+bool dispatchChannels(int channels, Fn&& fn) {
+    switch (channels) {
+        case 1: fn(PixelType<T, 1>{}); return true;
+        case 3: fn(PixelType<T, 3>{}); return true;
+        case 4: fn(PixelType<T, 4>{}); return true;
+        default: return false;
+    }
+}
+
+// Calls fn(PixelType<T, CN>{}) for the matching specialization. Returns false
+// for combinations without one, so callers can fall back to OpenCV. Pass
+// imageChannels(m) so planar images dispatch on their plane count.
+template <typename Fn>
+bool dispatchPixelType(int depth, int channels, Fn&& fn) {
+    switch (depth) {
+        case CV_8U:  return dispatchChannels<uint8_t>(channels, fn);
+        case CV_16U: return dispatchChannels<uint16_t>(channels, fn);
+        case CV_32F: return dispatchChannels<float>(channels, fn);
+        default:     return false;
+    }
+}
+
+// dst = src * alpha[c] + beta[c], per channel.
+template <typename T, int CN>
+void affineKernel(const cv::Mat& src, cv::Mat& dst,
+                  const std::array<float, CN>& alpha, const std::array<float, CN>& beta) {
+    dst.create(src.size(), src.type());
+
+    // size_t: a flattened image can hold more than INT_MAX samples
+    size_t rows = src.rows, cols = src.cols;
+    if (src.isContinuous() && dst.isContinuous()) {
+        cols *= rows;
+        rows = 1;
+    }
+
+    for (size_t y = 0; y < rows; ++y) {
+        const T* s = src.ptr<T>((int)y);
+        T* d = dst.ptr<T>((int)y);
+        for (size_t x = 0; x < cols; ++x) {
+            for (int c = 0; c < CN; ++c) {
+                d[x * CN + c] = clampPixel<T>(s[x * CN + c] * alpha[c] + beta[c]);
+            }
+        }
+    }
+}
+
+// 8-bit has only 256 possible inputs per channel: a table beats any arithmetic.
+template <int CN>
+void affineKernel8U(const cv::Mat& src, cv::Mat& dst,
+                    const std::array<float, CN>& alpha, const std::array<float, CN>& beta) {
+    cv::Mat lut(1, 256, CV_8UC(CN));
+    uint8_t* table = lut.ptr<uint8_t>();
+    for (int v = 0; v < 256; ++v) {
+        for (int c = 0; c < CN; ++c) {
+            table[v * CN + c] = clampPixel<uint8_t>(v * alpha[c] + beta[c]);
+        }
+    }
+    cv::LUT(src, lut, dst);
+}
+
+template <typename T, int CN>
+void applyAffine(const cv::Mat& src, cv::Mat& dst,
+                 const std::array<float, CN>& alpha, const std::array<float, CN>& beta) {
+    if constexpr (std::is_same_v<T, uint8_t>) {
+        affineKernel8U<CN>(src, dst, alpha, beta);
+    } else {
+        affineKernel<T, CN>(src, dst, alpha, beta);
+    }
+}
+
+// Planar variant: each plane is a contiguous single-channel run, so the
+// per-plane loop is the CN = 1 kernel with that channel's coefficients.
+template <typename T, int CN>
+void applyAffinePlanar(const cv::Mat& src, cv::Mat& dst,
+                       const std::array<float, CN>& alpha, const std::array<float, CN>& beta) {
+    createPlanar(dst, imageSize(src), CN, src.depth());
+    for (int c = 0; c < CN; ++c) {
+        cv::Mat out = planeView(dst, c);
+        applyAffine<T, 1>(planeView(src, c), out, { alpha[c] }, { beta[c] });
+    }
+}
+
+// Four-channel images inside the graph are premultiplied BGRA: colour already
+// carries coverage, so filters and composites need no per-pixel divide. The
+// divide happens once, in unpremultiplyKernel, when leaving the graph.
+template <typename T>
+void premultiplyKernel(cv::Mat& img) {
+    const float inv = 1.0f / PixelTraits<T>::maxValue;
+    for (int y = 0; y < img.rows; ++y) {
+        T* p = img.ptr<T>(y);
+        for (int x = 0; x < img.cols; ++x) {
+            float a = p[x * 4 + 3] * inv;
+            for (int c = 0; c < 3; ++c) {
+                p[x * 4 + c] = clampPixel<T>(p[x * 4 + c] * a);
+            }
+        }
+    }
+}
+
+template <typename T>
+void unpremultiplyKernel(cv::Mat& img) {
+    const float maxValue = PixelTraits<T>::maxValue;
+    for (int y = 0; y < img.rows; ++y) {
+        T* p = img.ptr<T>(y);
+        for (int x = 0; x < img.cols; ++x) {
+            float a = p[x * 4 + 3];
+            float scale = a > 0 ? maxValue / a : 0.0f;
+            for (int c = 0; c < 3; ++c) {
+                p[x * 4 + c] = clampPixel<T>(p[x * 4 + c] * scale);
+            }
+        }
+    }
+}
+
+// Affine on premultiplied BGRA: colour = colour * contrast + offset * alpha,
+// which equals applying the affine to the straight colour and re-multiplying.
+// Alpha passes through. Integer colour stays within [0, alpha]; float colour
+// is not clamped, like the three-channel float path (clampPixel<float>), so
+// brightness and contrast keep HDR values whether or not there is alpha.
+template <typename T>
+void affinePremultipliedKernel(const cv::Mat& src, cv::Mat& dst, float contrast, float offset) {
+    const float k = offset / PixelTraits<T>::maxValue;
+    auto store = [](float v, T a) -> T {
+        if constexpr (std::is_same_v<T, float>) return v;
+        else return clampPixelTo<T>(v, a);
+    };
+
+    if (isPlanar(src)) {
+        createPlanar(dst, imageSize(src), 4, src.depth());
+        cv::Mat alphaOut = planeView(dst, 3);
+        planeView(src, 3).copyTo(alphaOut);
+
+        for (int c = 0; c < 3; ++c) {
+            cv::Mat in = planeView(src, c), out = planeView(dst, c);
+            for (int y = 0; y < in.rows; ++y) {
+                const T* s = in.ptr<T>(y);
+                const T* a = alphaOut.ptr<T>(y);
+                T* d = out.ptr<T>(y);
+                for (int x = 0; x < in.cols; ++x) {
+                    d[x] = store(s[x] * contrast + a[x] * k, a[x]);
+                }
+            }
+        }
+        return;
+    }
+
+    dst.create(src.size(), src.type());
+    for (int y = 0; y < src.rows; ++y) {
+        const T* s = src.ptr<T>(y);
+        T* d = dst.ptr<T>(y);
+        for (int x = 0; x < src.cols; ++x) {
+            T a = s[x * 4 + 3];
+            for (int c = 0; c < 3; ++c) {
+                d[x * 4 + c] = store(s[x * 4 + c] * contrast + a * k, a);
+            }
+            d[x * 4 + 3] = a;
+        }
+    }
+}
+
+// Copies channel `channel` of an interleaved CN-channel image into a 1-channel image.
+template <typename T, int CN>
+void extractChannelKernel(const cv::Mat& src, cv::Mat& dst, int channel) {
+    dst.create(src.size(), CV_MAKETYPE(src.depth(), 1));
+
+    // size_t: a flattened image can hold more than INT_MAX samples
+    size_t rows = src.rows, cols = src.cols;
+    if (src.isContinuous() && dst.isContinuous()) {
+        cols *= rows;
+        rows = 1;
+    }
+
+    for (size_t y = 0; y < rows; ++y) {
+        const T* s = src.ptr<T>((int)y) + channel;
+        T* d = dst.ptr<T>((int)y);
+        for (size_t x = 0; x < cols; ++x) {
+            d[x] = s[x * CN];
+        }
+    }
+}
+
+// Grayscale rows of an interleaved or planar image, converted on demand.
+// Four-channel input is premultiplied, so its gray already fades with alpha
+// and edge/threshold masks follow the visible coverage.
+template <typename T, int CN>
+class GrayRows {
+    cv::Mat image;
+    std::array<cv::Mat, CN> planes;
+    bool planar;
+    float scale;
+
+public:
+    GrayRows(const cv::Mat& src, float scale) : image(src), planar(isPlanar(src)), scale(scale) {
+        if (planar) {
+            for (int c = 0; c < CN; ++c) planes[c] = planeView(src, c);
+        }
+    }
+
+    int rows() const { return imageSize(image).height; }
+    int cols() const { return imageSize(image).width; }
+
+    void read(int y, float* out) const {
+        int n = cols();
+        if constexpr (CN == 1) {
+            const T* s = planar ? planes[0].template ptr<T>(y) : image.template ptr<T>(y);
+            for (int x = 0; x < n; ++x) out[x] = s[x] * scale;
+        } else if (planar) {
+            const T* b = planes[0].template ptr<T>(y);
+            const T* g = planes[1].template ptr<T>(y);
+            const T* r = planes[2].template ptr<T>(y);
+            for (int x = 0; x < n; ++x) {
+                out[x] = (0.114f * b[x] + 0.587f * g[x] + 0.299f * r[x]) * scale;
+            }
+        } else {
+            const T* s = image.template ptr<T>(y);
+            for (int x = 0; x < n; ++x) {
+                out[x] = (0.114f * s[x * CN] + 0.587f * s[x * CN + 1] + 0.299f * s[x * CN + 2]) * scale;
+            }
+        }
+    }
+};
@@ -0,0 +1,150 @@
+#include "RawImage.h"
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../core/ImageLayout.h"
+
+namespace {
+
+// Lets a cv::Mat own an mmap'd region: when the last Mat referencing it is
+// released, OpenCV calls deallocate() and we unmap. New allocations (e.g. a
+// Mat::create() with another size) are delegated to the standard allocator.
+class MappedFileAllocator : public cv::MatAllocator {
+public:
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override {
+        return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+    }
+
+    bool allocate(cv::UMatData* data, cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override {
+        return cv::Mat::getStdAllocator()->allocate(data, flags, usageFlags);
+    }
+
+    void deallocate(cv::UMatData* u) const override {
+        if (!u) return;
+        munmap(u->origdata, u->size);
+        delete u;
+    }
+};
+
+MappedFileAllocator mappedFileAllocator;
+
+// out = a * b; false if that overflows. Header fields come from the file and
+// are checked against its size, so none of the arithmetic may wrap.
+bool multiplyChecked(uint64_t a, uint64_t b, uint64_t& out) {
+    if (b != 0 && a > UINT64_MAX / b) return false;
+    out = a * b;
+    return true;
+}
+
+}
+
+bool writeRawImage(const std::string& path, const cv::Mat& image) {
+    if (image.empty()) return false;
+
+    bool planar = isPlanar(image);
+    cv::Size size = imageSize(image);
+    int channels = imageChannels(image);
+    size_t rowBytes = size.width * image.elemSize(); // elemSize() is per plane when planar
+
+    RawImageHeader header {};
+    std::memcpy(header.magic, "NBRW", 4);
+    header.version = 1;
+    header.width = size.width;
+    header.height = size.height;
+    header.depth = image.depth();
+    header.channels = channels;
+    header.flags = (planar ? kRawImagePlanar : 0) | (channels == 4 ? kRawImagePremultiplied : 0);
+    header.stride = rowBytes;
+    header.dataOffset = sizeof(RawImageHeader);
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    if (image.isContinuous()) {
+        ok = ok && std::fwrite(image.data, image.total() * image.elemSize(), 1, file) == 1;
+    } else {
+        for (int c = 0; ok && c < (planar ? channels : 1); ++c) {
+            cv::Mat rows = planar ? planeView(image, c) : image;
+            for (int y = 0; ok && y < rows.rows; ++y) {
+                ok = std::fwrite(rows.ptr(y), rowBytes, 1, file) == 1;
+            }
+        }
+    }
+
+    ok = std::fclose(file) == 0 && ok;
+    return ok;
+}
+
+cv::Mat mapRawImage(const std::string& path, RawImageHeader* headerOut) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return cv::Mat();
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(RawImageHeader)) {
+        close(fd);
+        return cv::Mat();
+    }
+
+    size_t length = st.st_size;
+    void* base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file alive
+    if (base == MAP_FAILED) return cv::Mat();
+
+    RawImageHeader header;
+    std::memcpy(&header, base, sizeof(header));
+
+    int channels = (int)header.channels;
+    bool planar = header.flags & kRawImagePlanar;
+
+    // only the working depths; anything else is corrupt or from another tool
+    bool valid = std::memcmp(header.magic, "NBRW", 4) == 0 && header.version == 1 &&
+                 (header.depth == CV_8U || header.depth == CV_16U || header.depth == CV_32F) &&
+                 header.channels >= 1 && header.channels <= 4 &&
+                 header.width > 0 && header.height > 0 &&
+                 header.width <= (uint32_t)INT_MAX && header.height <= (uint32_t)INT_MAX;
+    if (valid) {
+        // width * elemSize <= stride, stride * height * planes <= bytes after the header
+        uint64_t elemSize1 = CV_ELEM_SIZE1(header.depth);
+        uint64_t rowBytes = 0, planeBytes = 0, imageBytes = 0;
+        valid = multiplyChecked(header.width, elemSize1 * (planar ? 1 : channels), rowBytes) &&
+                header.stride >= rowBytes && header.stride % elemSize1 == 0 &&
+                multiplyChecked(header.stride, header.height, planeBytes) &&
+                multiplyChecked(planeBytes, planar ? channels : 1, imageBytes) &&
+                header.dataOffset >= sizeof(RawImageHeader) && header.dataOffset <= length &&
+                imageBytes <= length - header.dataOffset;
+    }
+    if (!valid) {
+        std::cerr << "Not a valid raw image: " << path << std::endl;
+        munmap(base, length);
+        return cv::Mat();
+    }
+
+    if (headerOut) *headerOut = header;
+
+    uchar* pixels = static_cast<uchar*>(base) + header.dataOffset;
+    cv::Mat image;
+    if (planar) {
+        int sizes[3] = { channels, (int)header.height, (int)header.width };
+        size_t steps[2] = { header.stride * header.height, header.stride };
+        image = cv::Mat(3, sizes, CV_MAKETYPE(header.depth, 1), pixels, steps);
+    } else {
+        image = cv::Mat(header.height, header.width, CV_MAKETYPE(header.depth, channels), pixels, header.stride);
+    }
+
+    // hand ownership of the mapping to the Mat's reference count
+    cv::UMatData* u = new cv::UMatData(&mappedFileAllocator);
+    u->data = u->origdata = static_cast<uchar*>(base);
+    u->size = length;
+    u->refcount = 1;
+    image.u = u;
+    image.allocator = &mappedFileAllocator;
+    return image;
+}
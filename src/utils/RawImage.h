@@ -0,0 +1,56 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+
+// Minimal headered raw format for passing intermediates between graph runs
+// and external tools without encode/decode cost. Pixels are stored exactly as
+// the graph holds them (working depth, premultiplied alpha, interleaved or
+// planar), after a fixed 64-byte little-endian header:
+//
+//   offset  size  field
+//   0       4     magic "NBRW"
+//   4       4     version (1)
+//   8       4     width
+//   12      4     height
+//   16      4     OpenCV depth code: CV_8U, CV_16U or CV_32F
+//   20      4     channels
+//   24      4     flags (bit 0: planar, bit 1: premultiplied alpha)
+//   28      4     reserved
+//   32      8     row stride in bytes (per plane when planar)
+//   40      8     offset of the first pixel (64)
+//   48      16    reserved
+//
+// Rows are stored back to back at the given stride; planar files store plane
+// after plane. The pixel offset keeps data 64-byte aligned for SIMD loads.
+
+struct RawImageHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t channels;
+    uint32_t flags;
+    uint32_t reserved0;
+    uint64_t stride;
+    uint64_t dataOffset;
+    uint8_t reserved1[16];
+};
+static_assert(sizeof(RawImageHeader) == 64, "raw image header must be 64 bytes");
+
+constexpr uint32_t kRawImagePlanar = 1u << 0;
+constexpr uint32_t kRawImagePremultiplied = 1u << 1;
+
+inline bool isRawImagePath(const std::string& path) {
+    const std::string extension = ".nbraw";
+    return path.size() >= extension.size() &&
+           path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+bool writeRawImage(const std::string& path, const cv::Mat& image);
+
+// Maps the file and returns a Mat pointing straight into the mapping (private,
+// copy-on-write, so in-place kernels never touch the file). The mapping lives
+// as long as any Mat referencing it. Returns an empty Mat on failure.
+cv::Mat mapRawImage(const std::string& path, RawImageHeader* headerOut = nullptr);
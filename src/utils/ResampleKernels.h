@@ -0,0 +1,154 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "PixelKernels.h"
+
+// Separable resampling. Each axis gets a weight table, built once per
+// (source length, target length, filter): for every output position, the
+// first source index and a fixed number of taps. The passes then only do
+// multiply-adds over contiguous memory; the vertical pass runs along whole
+// rows, which the compiler vectorizes.
+
+enum class ResampleFilter { Nearest, Bilinear, Bicubic, Lanczos, Area };
+
+struct ResampleTable {
+    int taps = 0;
+    std::vector<int> start;      // first source index per output position
+    std::vector<float> weights;  // taps per output position, summing to 1
+
+    static float support(ResampleFilter filter) {
+        switch (filter) {
+            case ResampleFilter::Bilinear: return 1.0f;
+            case ResampleFilter::Bicubic:  return 2.0f;
+            case ResampleFilter::Lanczos:  return 3.0f;
+            default:                       return 0.5f;
+        }
+    }
+
+    static float weight(ResampleFilter filter, float x) {
+        x = std::abs(x);
+        switch (filter) {
+            case ResampleFilter::Bilinear:
+                return std::max(0.0f, 1.0f - x);
+            case ResampleFilter::Bicubic: // Keys, a = -0.5 (Catmull-Rom)
+                if (x < 1.0f) return (1.5f * x - 2.5f) * x * x + 1.0f;
+                if (x < 2.0f) return ((-0.5f * x + 2.5f) * x - 4.0f) * x + 2.0f;
+                return 0.0f;
+            case ResampleFilter::Lanczos: {
+                if (x < 1e-6f) return 1.0f;
+                if (x >= 3.0f) return 0.0f;
+                float px = (float)CV_PI * x;
+                return 3.0f * std::sin(px) * std::sin(px / 3.0f) / (px * px);
+            }
+            default: // Area: box
+                return x < 0.5f ? 1.0f : (x == 0.5f ? 0.5f : 0.0f);
+        }
+    }
+
+    // When shrinking, the filter is stretched by the scale factor so every
+    // source pixel contributes (no aliasing); weights past the image edge
+    // are dropped and the rest renormalized.
+    static ResampleTable build(int srcLength, int dstLength, ResampleFilter filter) {
+        ResampleTable table;
+        double scale = (double)srcLength / dstLength;
+
+        if (filter == ResampleFilter::Nearest) {
+            table.taps = 1;
+            table.weights.assign(dstLength, 1.0f);
+            table.start.resize(dstLength);
+            for (int i = 0; i < dstLength; ++i) {
+                table.start[i] = std::min((int)((i + 0.5) * scale), srcLength - 1);
+            }
+            return table;
+        }
+
+        // area averaging only differs from interpolation when shrinking
+        if (filter == ResampleFilter::Area && scale < 1.0) filter = ResampleFilter::Bilinear;
+
+        double stretch = std::max(scale, 1.0);
+        double radius = support(filter) * stretch;
+        table.taps = std::min((int)std::ceil(radius) * 2 + 1, srcLength);
+        table.start.resize(dstLength);
+        table.weights.assign((size_t)dstLength * table.taps, 0.0f);
+
+        for (int i = 0; i < dstLength; ++i) {
+            double center = (i + 0.5) * scale;
+            int lo = std::max((int)std::floor(center - radius), 0);
+            int hi = std::min((int)std::ceil(center + radius), srcLength);
+            int first = std::min(lo, srcLength - table.taps);
+            float* w = &table.weights[(size_t)i * table.taps];
+
+            double sum = 0;
+            for (int s = std::max(lo, first); s < std::min(hi, first + table.taps); ++s) {
+                float value = weight(filter, (float)((s + 0.5 - center) / stretch));
+                w[s - first] = value;
+                sum += value;
+            }
+            if (sum != 0) {
+                for (int k = 0; k < table.taps; ++k) w[k] = (float)(w[k] / sum);
+            } else {
+                // window between two samples (tiny box): take the nearest
+                w[std::min(std::max((int)center, first), first + table.taps - 1) - first] = 1.0f;
+            }
+            table.start[i] = first;
+        }
+        return table;
+    }
+};
+
+// Stores a float pixel. Ringing filters can push premultiplied colour past
+// its alpha or below zero; four-channel colour is clamped to alpha.
+template <typename T, int CN>
+inline void storeResampled(const float* v, T* d) {
+    if constexpr (CN == 4) {
+        float a = std::min(std::max(v[3], 0.0f), PixelTraits<T>::maxValue);
+        for (int c = 0; c < 3; ++c) d[c] = clampPixelTo<T>(v[c], a);
+        d[3] = clampPixel<T>(a);
+    } else {
+        for (int c = 0; c < CN; ++c) d[c] = clampPixel<T>(v[c]);
+    }
+}
+
+// Interleaved CN-channel src -> dst of size (xTable.start.size(),
+// yTable.start.size()). Horizontal pass first into a float buffer of the
+// target width (shrinking first touches fewer pixels), then vertical.
+template <typename T, int CN>
+void resampleKernel(const cv::Mat& src, cv::Mat& dst, const ResampleTable& xTable, const ResampleTable& yTable) {
+    const int dstCols = (int)xTable.start.size(), dstRows = (int)yTable.start.size();
+    const int rowLength = dstCols * CN;
+    cv::Mat horizontal(src.rows, rowLength, CV_32F);
+
+    cv::parallel_for_(cv::Range(0, src.rows), [&](const cv::Range& band) {
+        for (int y = band.start; y < band.end; ++y) {
+            const T* s = src.ptr<T>(y);
+            float* h = horizontal.ptr<float>(y);
+            for (int x = 0; x < dstCols; ++x) {
+                const T* p = s + xTable.start[x] * CN;
+                const float* w = &xTable.weights[(size_t)x * xTable.taps];
+                float acc[CN] = {};
+                for (int k = 0; k < xTable.taps; ++k) {
+                    for (int c = 0; c < CN; ++c) acc[c] += w[k] * p[k * CN + c];
+                }
+                for (int c = 0; c < CN; ++c) h[x * CN + c] = acc[c];
+            }
+        }
+    });
+
+    dst.create(dstRows, dstCols, src.type());
+    cv::parallel_for_(cv::Range(0, dstRows), [&](const cv::Range& band) {
+        std::vector<float> acc(rowLength);
+        for (int y = band.start; y < band.end; ++y) {
+            const float* w = &yTable.weights[(size_t)y * yTable.taps];
+            std::fill(acc.begin(), acc.end(), 0.0f);
+            for (int k = 0; k < yTable.taps; ++k) {
+                const float* h = horizontal.ptr<float>(yTable.start[y] + k);
+                const float wk = w[k];
+                for (int i = 0; i < rowLength; ++i) acc[i] += wk * h[i];
+            }
+            T* d = dst.ptr<T>(y);
+            for (int x = 0; x < dstCols; ++x) storeResampled<T, CN>(&acc[x * CN], d + x * CN);
+        }
+    });
+}
@@ -0,0 +1,66 @@
+#include "SharedMemory.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SharedSegmentMap::~SharedSegmentMap() {
+    for (const auto& segment : segments) {
+        munmap(segment.base, segment.size);
+    }
+}
+
+uchar* SharedSegmentMap::map(int fd, size_t& size) {
+    // an unsealed segment could be truncated under a cached mapping, and the
+    // next access would raise SIGBUS in the server
+    int seals = fcntl(fd, F_GET_SEALS);
+    if (seals < 0 || !(seals & F_SEAL_SHRINK)) return nullptr;
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) return nullptr;
+
+    for (const auto& segment : segments) {
+        if (segment.device == st.st_dev && segment.inode == st.st_ino && segment.size == (size_t)st.st_size) {
+            size = segment.size;
+            return segment.base;
+        }
+    }
+
+    void* base = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    if (base == MAP_FAILED) return nullptr;
+
+    if (segments.size() >= kMaxSegments) {
+        // oldest first; the client has moved on to other segments
+        munmap(segments.front().base, segments.front().size);
+        segments.erase(segments.begin());
+    }
+    segments.push_back({ st.st_dev, st.st_ino, (size_t)st.st_size, static_cast<uchar*>(base) });
+    size = st.st_size;
+    return static_cast<uchar*>(base);
+}
+
+cv::Mat sharedImageView(uchar* base, size_t size, const SharedImageDesc& desc) {
+    int type = (int)desc.type;
+    int channels = CV_MAT_CN(type);
+    size_t rowBytes = (size_t)desc.width * CV_ELEM_SIZE(type);
+
+    bool valid = base && desc.width > 0 && desc.height > 0 && desc.width <= 1u << 16 && desc.height <= 1u << 16 &&
+                 CV_MAT_DEPTH(type) <= CV_32F && (channels == 1 || channels == 3 || channels == 4) &&
+                 desc.stride >= rowBytes && desc.offset < size && rowBytes <= size - desc.offset &&
+                 // stride * (height - 1) + rowBytes fits, checked without multiplying:
+                 // the stride comes from the client and may be anything
+                 (desc.height == 1 || desc.stride <= (size - desc.offset - rowBytes) / (desc.height - 1));
+    if (!valid) return cv::Mat();
+
+    return cv::Mat((int)desc.height, (int)desc.width, type, base + desc.offset, desc.stride);
+}
+
+int createSharedSegment(const std::string& name, size_t size) {
+    int fd = memfd_create(name.c_str(), MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) return -1;
+    if (ftruncate(fd, (off_t)size) != 0 || fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
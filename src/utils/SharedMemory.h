@@ -0,0 +1,58 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+// Where an interleaved image lives inside a shared memory segment (a memfd
+// passed over the server socket). Part of the server wire protocol, so the
+// layout is fixed.
+struct SharedImageDesc {
+    uint32_t width;
+    uint32_t height;
+    uint32_t type;      // OpenCV type: CV_8UC3, CV_16UC4, CV_32FC3, ...
+    uint32_t reserved;
+    uint64_t offset;    // byte offset of the first pixel in the segment
+    uint64_t stride;    // bytes per row
+};
+static_assert(sizeof(SharedImageDesc) == 32, "shared image descriptor must be 32 bytes");
+
+// Whole-segment mappings for one connection, keyed by the file behind the fd,
+// so a client cycling through the same few memfds pays for mmap and page
+// table setup once instead of once per frame. Mappings are shared (the
+// client sees what is written into them) and live until this is destroyed.
+class SharedSegmentMap {
+public:
+    SharedSegmentMap() = default;
+    ~SharedSegmentMap();
+
+    SharedSegmentMap(const SharedSegmentMap&) = delete;
+    SharedSegmentMap& operator=(const SharedSegmentMap&) = delete;
+
+    // Base address of the segment behind fd and its size, or nullptr. The fd
+    // must carry F_SEAL_SHRINK (see createSharedSegment); mappings are cached,
+    // so a segment that could shrink would fault the server on a later access.
+    // The fd itself is not kept.
+    uchar* map(int fd, size_t& size);
+
+private:
+    struct Segment {
+        dev_t device;
+        ino_t inode;
+        size_t size;
+        uchar* base;
+    };
+    static constexpr size_t kMaxSegments = 8;
+    std::vector<Segment> segments;
+};
+
+// Mat header over `desc` inside a mapped segment (no copy, no ownership), or
+// an empty Mat if the descriptor does not fit in `size` bytes.
+cv::Mat sharedImageView(uchar* base, size_t size, const SharedImageDesc& desc);
+
+// For clients: an anonymous shared memory segment of `size` bytes, ready to
+// be mapped and passed to the server. The segment is sealed with
+// F_SEAL_SHRINK, which the server requires: it can grow but never shrink, so
+// a mapping of it stays valid. Returns -1 on failure.
+int createSharedSegment(const std::string& name, size_t size);
@@ -0,0 +1,64 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include "../core/ImageFormat.h"
+#include "../core/ImageLayout.h"
+#include "PixelKernels.h"
+#include "RawImage.h"
+
+// Size of a 1/proxyScale preview: rounded up, which is what libjpeg's reduced
+// decode produces, so every source of the same image agrees on it.
+inline cv::Size proxySize(cv::Size full, int proxyScale) {
+    return cv::Size((full.width + proxyScale - 1) / proxyScale, (full.height + proxyScale - 1) / proxyScale);
+}
+
+// Brings a freshly decoded image into the graph's conventions: BGR or
+// premultiplied BGRA, the working depth, and the planar layout if enabled.
+// proxyScale > 1 shrinks a full-resolution decode to proxySize() first.
+// Every source node funnels its decoded pixels through here.
+inline cv::Mat prepareSourceImage(cv::Mat image, WorkingFormat format, bool planar, int proxyScale = 1) {
+    if (image.empty()) return image;
+
+    if (proxyScale > 1) {
+        cv::resize(image, image, proxySize(image.size(), proxyScale), 0, 0, cv::INTER_AREA);
+    }
+    if (image.channels() == 1) {
+        cv::cvtColor(image, image, cv::COLOR_GRAY2BGR);
+    }
+    convertDepth(image, image, formatDepth(format));
+    if (image.channels() == 4) {
+        dispatchPixelType(image.depth(), 1, [&](auto pixel) {
+            premultiplyKernel<typename decltype(pixel)::Type>(image);
+        });
+    }
+    if (planar) {
+        image = toPlanar(image);
+    }
+    return image;
+}
+
+// Opens a .nbraw intermediate. Its pixels are already in graph form, so when
+// depth and layout match the working settings the mapped memory is used as-is.
+// A proxy preview is shrunk into a fresh buffer instead.
+inline cv::Mat loadRawSourceImage(const std::string& path, WorkingFormat format, bool planar, int proxyScale = 1) {
+    RawImageHeader header;
+    cv::Mat image = mapRawImage(path, &header);
+    if (image.empty()) return image;
+
+    if (imageChannels(image) == 4 && !(header.flags & kRawImagePremultiplied)) {
+        // straight alpha from an external tool: take the regular import path
+        // (the proxy shrink already copies out of the mapping)
+        cv::Mat interleaved = toInterleaved(image);
+        return prepareSourceImage(proxyScale > 1 ? interleaved : interleaved.clone(), format, planar, proxyScale);
+    }
+
+    if (proxyScale > 1) {
+        // premultiplied, so an area average needs no unpremultiply
+        cv::Mat interleaved = toInterleaved(image);
+        cv::resize(interleaved, image, proxySize(interleaved.size(), proxyScale), 0, 0, cv::INTER_AREA);
+    }
+
+    if (image.depth() != formatDepth(format)) {
+        convertDepth(image, image, formatDepth(format));
+    }
+    return planar ? toPlanar(image) : toInterleaved(image);
+}
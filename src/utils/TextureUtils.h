@@ -1,9 +1,24 @@
 #pragma once
 #include <opencv2/opencv.hpp>
 #include <GL/gl.h>
+#include "../core/ImageFormat.h"
+#include "../core/ImageLayout.h"
 
-inline GLuint matToTexture(const cv::Mat& mat) {
-    if (mat.empty()) return 0;
+#ifndef GL_HALF_FLOAT
+#define GL_HALF_FLOAT 0x140B
+#endif
+#ifndef GL_RGB16F
+#define GL_RGB16F 0x881B
+#endif
+#ifndef GL_RGBA16F
+#define GL_RGBA16F 0x881A
+#endif
+
+inline GLuint matToTexture(const cv::Mat& image) {
+    if (image.empty()) return 0;
+
+    // previews are always interleaved
+    cv::Mat mat = toInterleaved(image);
 
     GLuint textureID;
     glGenTextures(1, &textureID);
@@ -13,13 +28,29 @@ inline GLuint matToTexture(const cv::Mat& mat) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-    GLenum inputFormat = mat.channels() == 3 ? GL_BGR : GL_LUMINANCE;
+    GLenum inputFormat = mat.channels() == 4 ? GL_BGRA : mat.channels() == 3 ? GL_BGR : GL_LUMINANCE;
+    bool hasAlpha = mat.channels() == 4;
+
+    // rows of odd-width BGR / 16-bit images are not 4-byte aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-    glTexImage2D(
-        GL_TEXTURE_2D, 0, GL_RGB, mat.cols, mat.rows,
-        0, inputFormat, GL_UNSIGNED_BYTE, mat.ptr()
-    );
+    if (mat.depth() == CV_8U) {
+        glTexImage2D(
+            GL_TEXTURE_2D, 0, hasAlpha ? GL_RGBA : GL_RGB, mat.cols, mat.rows,
+            0, inputFormat, GL_UNSIGNED_BYTE, mat.ptr()
+        );
+    } else {
+        // High-bit-depth previews go up as half-float: keeps the extra
+        // precision visible without the bandwidth of a full float upload.
+        cv::Mat half;
+        mat.convertTo(half, CV_16F, 1.0 / depthMaxValue(mat.depth()));
+        glTexImage2D(
+            GL_TEXTURE_2D, 0, hasAlpha ? GL_RGBA16F : GL_RGB16F, half.cols, half.rows,
+            0, inputFormat, GL_HALF_FLOAT, half.ptr()
+        );
+    }
 
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     glBindTexture(GL_TEXTURE_2D, 0);
     return textureID;
-}
\ No newline at end of file
+}
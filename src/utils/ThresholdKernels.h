@@ -0,0 +1,131 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "PixelKernels.h"
+#include "IntegralImage.h"
+
+// Threshold kernels on the luminance of an image. All of them read the input
+// directly (gray is formed per row, never stored) and write a one-channel
+// mask of the input's depth: max where the pixel is above the threshold.
+
+// 8-bit gets one bin per value; deeper images are binned to 4096 levels,
+// which keeps the per-thread histograms in L1/L2 and is plenty for Otsu.
+inline int histogramBins(int depth) { return depth == CV_8U ? 256 : 4096; }
+
+// Luminance histogram with `bins` bins spanning [0, maxValue]. Each stripe of
+// rows counts into its own private histogram (no atomics, no false sharing
+// on a shared one); the stripes are summed at the end.
+template <typename T, int CN>
+std::vector<uint64_t> grayHistogram(const cv::Mat& src, int bins) {
+    GrayRows<T, CN> gray(src, (bins - 1) / PixelTraits<T>::maxValue);
+    const int rows = gray.rows(), cols = gray.cols();
+    const int stripes = std::max(1, std::min(cv::getNumThreads(), rows));
+    std::vector<std::vector<uint32_t>> local(stripes, std::vector<uint32_t>(bins, 0));
+
+    cv::parallel_for_(cv::Range(0, stripes), [&](const cv::Range& range) {
+        std::vector<float> row(cols);
+        for (int s = range.start; s < range.end; ++s) {
+            uint32_t* counts = local[s].data();
+            int end = (int)((int64_t)rows * (s + 1) / stripes);
+            for (int y = (int)((int64_t)rows * s / stripes); y < end; ++y) {
+                gray.read(y, row.data());
+                for (int x = 0; x < cols; ++x) {
+                    int bin = (int)std::min(std::max(row[x] + 0.5f, 0.0f), (float)(bins - 1));
+                    ++counts[bin];
+                }
+            }
+        }
+    }, stripes);
+
+    std::vector<uint64_t> histogram(bins, 0);
+    for (const auto& counts : local) {
+        for (int b = 0; b < bins; ++b) histogram[b] += counts[b];
+    }
+    return histogram;
+}
+
+// Bin maximizing the between-class variance; pixels in bins above it are
+// foreground.
+inline int otsuThreshold(const std::vector<uint64_t>& histogram) {
+    double total = 0, weightedTotal = 0;
+    for (size_t b = 0; b < histogram.size(); ++b) {
+        total += (double)histogram[b];
+        weightedTotal += (double)b * histogram[b];
+    }
+
+    double background = 0, weightedBackground = 0, best = -1;
+    int threshold = 0;
+    for (size_t b = 0; b < histogram.size(); ++b) {
+        background += (double)histogram[b];
+        if (background == 0) continue;
+        double foreground = total - background;
+        if (foreground == 0) break;
+
+        weightedBackground += (double)b * histogram[b];
+        double meanBackground = weightedBackground / background;
+        double meanForeground = (weightedTotal - weightedBackground) / foreground;
+        double between = background * foreground * (meanBackground - meanForeground) * (meanBackground - meanForeground);
+        if (between > best) {
+            best = between;
+            threshold = (int)b;
+        }
+    }
+    return threshold;
+}
+
+// Global threshold at `level` (in pixel units of T).
+template <typename T, int CN>
+void thresholdKernel(const cv::Mat& src, cv::Mat& dst, float level, bool invert) {
+    GrayRows<T, CN> gray(src, 1.0f);
+    cv::Mat out = createSingleChannel(src, dst);
+    const T on = invert ? T(0) : static_cast<T>(PixelTraits<T>::maxValue);
+    const T off = invert ? static_cast<T>(PixelTraits<T>::maxValue) : T(0);
+    const int cols = gray.cols();
+
+    cv::parallel_for_(cv::Range(0, gray.rows()), [&](const cv::Range& band) {
+        std::vector<float> row(cols);
+        for (int y = band.start; y < band.end; ++y) {
+            gray.read(y, row.data());
+            T* d = out.ptr<T>(y);
+            for (int x = 0; x < cols; ++x) {
+                d[x] = row[x] > level ? on : off;
+            }
+        }
+    });
+}
+
+// Local threshold: a pixel is foreground when its gray exceeds the mean gray
+// of the (2 * radius + 1)^2 window around it minus `offset` (pixel units).
+// The window mean comes from the gray summed-area table of src
+// (IntegralImage::computeGray), so the cost per pixel is independent of the
+// radius.
+template <typename T, int CN>
+void adaptiveThresholdKernel(const cv::Mat& src, cv::Mat& dst, const IntegralImage& sums,
+                             int radius, float offset, bool invert) {
+    GrayRows<T, CN> gray(src, 1.0f);
+    cv::Mat out = createSingleChannel(src, dst);
+    const T on = invert ? T(0) : static_cast<T>(PixelTraits<T>::maxValue);
+    const T off = invert ? static_cast<T>(PixelTraits<T>::maxValue) : T(0);
+    const int rows = gray.rows(), cols = gray.cols();
+
+    cv::parallel_for_(cv::Range(0, rows), [&](const cv::Range& band) {
+        std::vector<float> row(cols);
+        for (int y = band.start; y < band.end; ++y) {
+            gray.read(y, row.data());
+            int y0 = std::max(y - radius, 0), y1 = std::min(y + radius + 1, rows);
+            const double* top = sums.planes[0].ptr<double>(y0);
+            const double* bottom = sums.planes[0].ptr<double>(y1);
+
+            T* d = out.ptr<T>(y);
+            for (int x = 0; x < cols; ++x) {
+                int x0 = std::max(x - radius, 0), x1 = std::min(x + radius + 1, cols);
+                double sum = bottom[x1] - bottom[x0] - top[x1] + top[x0];
+                double mean = sum / ((x1 - x0) * (y1 - y0));
+                d[x] = row[x] > mean - offset ? on : off;
+            }
+        }
+    });
+}
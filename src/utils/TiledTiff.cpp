@@ -0,0 +1,217 @@
+#include "TiledTiff.h"
+#include <tiffio.h>
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+int tiffToMatDepth(uint16_t bits, uint16_t sampleFormat) {
+    if (bits == 8 && sampleFormat == SAMPLEFORMAT_UINT) return CV_8U;
+    if (bits == 16 && sampleFormat == SAMPLEFORMAT_UINT) return CV_16U;
+    if (bits == 32 && sampleFormat == SAMPLEFORMAT_IEEEFP) return CV_32F;
+    return -1;
+}
+
+// TIFF stores RGB(A); the graph works in BGR(A). Swapping is its own inverse.
+void swapRedBlue(cv::Mat& m) {
+    if (m.channels() == 3) cv::cvtColor(m, m, cv::COLOR_RGB2BGR);
+    else if (m.channels() == 4) cv::cvtColor(m, m, cv::COLOR_RGBA2BGRA);
+}
+
+}
+
+TiffRegionReader::TiffRegionReader(const std::string& path, size_t cacheTiles) : cacheTiles(std::max<size_t>(cacheTiles, 1)) {
+    tiff = TIFFOpen(path.c_str(), "r");
+    if (!tiff) return;
+
+    uint16_t samples = 1, bits = 8, sampleFormat = SAMPLEFORMAT_UINT, planarConfig = PLANARCONFIG_CONTIG;
+    TIFFGetField(tiff, TIFFTAG_IMAGEWIDTH, &width);
+    TIFFGetField(tiff, TIFFTAG_IMAGELENGTH, &height);
+    TIFFGetFieldDefaulted(tiff, TIFFTAG_SAMPLESPERPIXEL, &samples);
+    TIFFGetFieldDefaulted(tiff, TIFFTAG_BITSPERSAMPLE, &bits);
+    TIFFGetFieldDefaulted(tiff, TIFFTAG_SAMPLEFORMAT, &sampleFormat);
+    TIFFGetFieldDefaulted(tiff, TIFFTAG_PLANARCONFIG, &planarConfig);
+
+    int depth = tiffToMatDepth(bits, sampleFormat);
+    if (depth < 0 || planarConfig != PLANARCONFIG_CONTIG || (samples != 1 && samples != 3 && samples != 4)) {
+        std::cerr << "Unsupported TIFF layout for streaming: " << path << std::endl;
+        TIFFClose(tiff);
+        tiff = nullptr;
+        return;
+    }
+    matType = CV_MAKETYPE(depth, samples);
+
+    tiled = TIFFIsTiled(tiff);
+    if (tiled) {
+        TIFFGetField(tiff, TIFFTAG_TILEWIDTH, &tileWidth);
+        TIFFGetField(tiff, TIFFTAG_TILELENGTH, &tileHeight);
+    } else {
+        tileWidth = width;
+        TIFFGetFieldDefaulted(tiff, TIFFTAG_ROWSPERSTRIP, &tileHeight);
+        tileHeight = std::min(tileHeight, height);
+        if (tileHeight > kMaxStripRows) {
+            // decoding the strip would hold (and cache) most of the image
+            scanlines = true;
+            tileHeight = std::min(kScanlineBandRows, height);
+        }
+    }
+}
+
+TiffRegionReader::~TiffRegionReader() {
+    if (tiff) TIFFClose(tiff);
+}
+
+const cv::Mat& TiffRegionReader::loadTile(uint32_t tx, uint32_t ty) {
+    uint32_t index = tiled ? TIFFComputeTile(tiff, tx * tileWidth, ty * tileHeight, 0, 0)
+                   : scanlines ? ty
+                   : TIFFComputeStrip(tiff, ty * tileHeight, 0);
+
+    auto it = cache.find(index);
+    if (it != cache.end()) {
+        it->second.lastUse = ++useCounter;
+        return it->second.pixels;
+    }
+
+    evictDownTo(cacheTiles - 1);
+
+    cv::Mat tile((int)tileHeight, (int)tileWidth, matType, cv::Scalar::all(0));
+    if (scanlines) {
+        // a compressed strip only decodes forwards: going back to an earlier
+        // row restarts from the top of the strip, so the cache should hold a
+        // request's halo and requests should move down the image
+        uint32_t first = ty * tileHeight, last = std::min(first + tileHeight, height);
+        for (uint32_t row = first; row < last; ++row) {
+            if (TIFFReadScanline(tiff, tile.ptr((int)(row - first)), row, 0) < 0) {
+                std::cerr << "Failed to read TIFF scanline " << row << std::endl;
+                break;
+            }
+        }
+    } else {
+        tmsize_t bytes = tiled
+            ? TIFFReadEncodedTile(tiff, index, tile.data, (tmsize_t)(tile.total() * tile.elemSize()))
+            : TIFFReadEncodedStrip(tiff, index, tile.data, (tmsize_t)(tile.total() * tile.elemSize()));
+        if (bytes < 0) {
+            std::cerr << "Failed to read TIFF " << (tiled ? "tile " : "strip ") << index << std::endl;
+        }
+    }
+    swapRedBlue(tile);
+    CachedTile& entry = cache[index];
+    entry.pixels = tile;
+    entry.lastUse = ++useCounter;
+    return entry.pixels;
+}
+
+size_t TiffRegionReader::tilesForRows(int rows) const {
+    if (!tiff || rows <= 0) return 0;
+    size_t across = (width + tileWidth - 1) / tileWidth;
+    // an unaligned region straddles one more tile row than it fills
+    size_t down = ((size_t)rows + tileHeight - 1) / tileHeight + 1;
+    return across * down;
+}
+
+void TiffRegionReader::setCacheTiles(size_t tiles) {
+    cacheTiles = std::max<size_t>(tiles, 1);
+    evictDownTo(cacheTiles);
+}
+
+void TiffRegionReader::evictDownTo(size_t count) {
+    // least recently used first; a linear scan is nothing next to a decode
+    while (cache.size() > count) {
+        auto stalest = std::min_element(cache.begin(), cache.end(), [](const auto& a, const auto& b) {
+            return a.second.lastUse < b.second.lastUse;
+        });
+        cache.erase(stalest);
+    }
+}
+
+cv::Mat TiffRegionReader::readRegion(const cv::Rect& requested) {
+    cv::Rect region = requested & cv::Rect(0, 0, (int)width, (int)height);
+    if (!tiff || region.empty()) return cv::Mat();
+
+    cv::Mat out(region.size(), matType);
+    uint32_t tx0 = region.x / tileWidth, tx1 = (region.x + region.width - 1) / tileWidth;
+    uint32_t ty0 = region.y / tileHeight, ty1 = (region.y + region.height - 1) / tileHeight;
+
+    for (uint32_t ty = ty0; ty <= ty1; ++ty) {
+        for (uint32_t tx = tx0; tx <= tx1; ++tx) {
+            const cv::Mat& tile = loadTile(tx, ty);
+            cv::Rect tileRect((int)(tx * tileWidth), (int)(ty * tileHeight), tile.cols, tile.rows);
+            cv::Rect overlap = tileRect & region;
+            if (overlap.empty()) continue;
+
+            tile(overlap - tileRect.tl()).copyTo(out(overlap - region.tl()));
+        }
+    }
+    return out;
+}
+
+TiffStripWriter::TiffStripWriter(const std::string& path, cv::Size size, int type, int rowsPerStrip)
+    : size(size), type(type), rowsPerStrip(std::max(rowsPerStrip, 1)) {
+    int depth = CV_MAT_DEPTH(type), channels = CV_MAT_CN(type);
+    if ((depth != CV_8U && depth != CV_16U && depth != CV_32F) || (channels != 1 && channels != 3 && channels != 4)) {
+        std::cerr << "Unsupported type for TIFF output" << std::endl;
+        return;
+    }
+
+    double bytes = (double)size.width * size.height * CV_ELEM_SIZE(type);
+    tiff = TIFFOpen(path.c_str(), bytes >= 4.0e9 ? "w8" : "w");
+    if (!tiff) return;
+
+    TIFFSetField(tiff, TIFFTAG_IMAGEWIDTH, (uint32_t)size.width);
+    TIFFSetField(tiff, TIFFTAG_IMAGELENGTH, (uint32_t)size.height);
+    TIFFSetField(tiff, TIFFTAG_SAMPLESPERPIXEL, (uint16_t)channels);
+    TIFFSetField(tiff, TIFFTAG_BITSPERSAMPLE, (uint16_t)(CV_ELEM_SIZE1(type) * 8));
+    TIFFSetField(tiff, TIFFTAG_SAMPLEFORMAT, depth == CV_32F ? SAMPLEFORMAT_IEEEFP : SAMPLEFORMAT_UINT);
+    TIFFSetField(tiff, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+    TIFFSetField(tiff, TIFFTAG_PHOTOMETRIC, channels == 1 ? PHOTOMETRIC_MINISBLACK : PHOTOMETRIC_RGB);
+    TIFFSetField(tiff, TIFFTAG_ROWSPERSTRIP, (uint32_t)this->rowsPerStrip);
+    TIFFSetField(tiff, TIFFTAG_COMPRESSION, COMPRESSION_LZW);
+    if (channels == 4) {
+        uint16_t extra[] = { EXTRASAMPLE_UNASSALPHA };
+        TIFFSetField(tiff, TIFFTAG_EXTRASAMPLES, 1, extra);
+    }
+
+    pending.create(this->rowsPerStrip, size.width, type);
+}
+
+TiffStripWriter::~TiffStripWriter() {
+    close();
+}
+
+bool TiffStripWriter::flushStrip() {
+    if (pendingRows == 0) return true;
+
+    tmsize_t bytes = (tmsize_t)pendingRows * size.width * CV_ELEM_SIZE(type);
+    if (TIFFWriteEncodedStrip(tiff, nextStrip++, pending.data, bytes) < 0) {
+        failed = true;
+    }
+    pendingRows = 0;
+    return !failed;
+}
+
+bool TiffStripWriter::appendRows(const cv::Mat& rows) {
+    if (!tiff || failed || rows.type() != type || rows.cols != size.width) return false;
+
+    int y = 0;
+    while (y < rows.rows && rowsWritten < size.height) {
+        int count = std::min({ rows.rows - y, rowsPerStrip - pendingRows, size.height - rowsWritten });
+        cv::Mat dst = pending.rowRange(pendingRows, pendingRows + count);
+        rows.rowRange(y, y + count).copyTo(dst);
+        swapRedBlue(dst);
+
+        y += count;
+        pendingRows += count;
+        rowsWritten += count;
+        if (pendingRows == rowsPerStrip && !flushStrip()) return false;
+    }
+    return true;
+}
+
+bool TiffStripWriter::close() {
+    if (!tiff) return false;
+
+    bool ok = flushStrip() && !failed && rowsWritten == size.height;
+    TIFFClose(tiff);
+    tiff = nullptr;
+    return ok;
+}
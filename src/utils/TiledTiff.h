@@ -0,0 +1,88 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <map>
+#include <string>
+
+typedef struct tiff TIFF;
+
+// Random-access reader for tiled or striped TIFFs too large to decode whole.
+// readRegion() decodes only the tiles (or strips) that intersect the request,
+// keeping the least recently used ones cached so overlapping requests (e.g.
+// strip halos) don't decode the same tile twice. Size the cache to hold every
+// tile of one request (see tilesForRows), or consecutive requests thrash. Supports chunky (interleaved) 8/16-bit
+// unsigned and 32-bit float data with 1, 3 or 4 samples; colour comes back
+// in OpenCV's BGR(A) order. Strips taller than kMaxStripRows (typically one
+// strip for the whole image) are read a band of scanlines at a time instead
+// of being decoded whole.
+class TiffRegionReader {
+public:
+    static constexpr uint32_t kMaxStripRows = 256;
+    static constexpr uint32_t kScanlineBandRows = 64; // tile height for taller strips
+
+    explicit TiffRegionReader(const std::string& path, size_t cacheTiles = 256);
+    ~TiffRegionReader();
+
+    TiffRegionReader(const TiffRegionReader&) = delete;
+    TiffRegionReader& operator=(const TiffRegionReader&) = delete;
+
+    bool isOpen() const { return tiff != nullptr; }
+    cv::Size size() const { return cv::Size((int)width, (int)height); }
+    int type() const { return matType; }
+    // Strips of a striped file count as full-width tiles, as do scanline bands.
+    cv::Size tileSize() const { return cv::Size((int)tileWidth, (int)tileHeight); }
+    // Tiles a full-width region of `rows` rows can touch, at any offset.
+    size_t tilesForRows(int rows) const;
+    void setCacheTiles(size_t tiles);
+
+    cv::Mat readRegion(const cv::Rect& region);
+
+private:
+    TIFF* tiff = nullptr;
+    uint32_t width = 0, height = 0;
+    uint32_t tileWidth = 0, tileHeight = 0; // strips are treated as full-width tiles
+    bool tiled = false;
+    bool scanlines = false; // tileHeight is a band of TIFFReadScanline rows
+    int matType = 0;
+    size_t cacheTiles;
+    struct CachedTile {
+        cv::Mat pixels;
+        uint64_t lastUse = 0;
+    };
+    std::map<uint32_t, CachedTile> cache;
+    uint64_t useCounter = 0;
+
+    const cv::Mat& loadTile(uint32_t tx, uint32_t ty);
+    void evictDownTo(size_t count);
+};
+
+// Writes a striped TIFF incrementally: rows are appended top to bottom and
+// each strip is compressed and written as soon as it is complete, so only
+// one strip is ever held in memory. Switches to BigTIFF past 4 GB.
+class TiffStripWriter {
+public:
+    // type is the OpenCV type of the rows that will be appended (BGR(A) order).
+    TiffStripWriter(const std::string& path, cv::Size size, int type, int rowsPerStrip = 64);
+    ~TiffStripWriter();
+
+    TiffStripWriter(const TiffStripWriter&) = delete;
+    TiffStripWriter& operator=(const TiffStripWriter&) = delete;
+
+    bool isOpen() const { return tiff != nullptr; }
+    bool appendRows(const cv::Mat& rows);
+    // Flushes the last partial strip and finalizes the file.
+    bool close();
+
+private:
+    TIFF* tiff = nullptr;
+    cv::Size size;
+    int type = 0;
+    int rowsPerStrip = 64;
+    int rowsWritten = 0;
+    uint32_t nextStrip = 0;
+    cv::Mat pending; // rows of the strip being assembled, in file (RGB) order
+    int pendingRows = 0;
+    bool failed = false;
+
+    bool flushStrip();
+};